@@ -0,0 +1,566 @@
+/* grok-bench.c
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Renders every op in the tree through a real GEGL graph at several
+ * canvas sizes, mipmap levels and thread counts, and reports Mpix/s,
+ * peak RSS and tile-cache hit rate as JSON.  With --baseline the numbers
+ * are compared against an earlier run and the exit status is non-zero
+ * when any case got slower than the tolerance allows.
+ *
+ *   grok-bench --module-dir build --output bench/baseline.json
+ *   grok-bench --module-dir build --baseline bench/baseline.json
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gegl.h>
+#include <json-glib/json-glib.h>
+
+#define BENCH_BAND_ROWS 256
+
+typedef struct
+{
+  const gchar *name;
+  void       (*configure) (GeglNode *node);
+} BenchOp;
+
+static void
+configure_pango_markup (GeglNode *node)
+{
+  GString *text = g_string_new (NULL);
+  gint     i;
+
+  for (i = 0; i < 200; i++)
+    g_string_append_printf (text,
+                            "<b>Line %d</b> of <i>benchmark</i> markup, "
+                            "<span foreground=\"#c03\">coloured</span> and wrapped.\n",
+                            i);
+
+  gegl_node_set (node,
+                 "text",      text->str,
+                 "font_size", 48.0,
+                 "wrap",      4096,
+                 NULL);
+  g_string_free (text, TRUE);
+}
+
+static const BenchOp bench_ops[] =
+{
+  { "gegl:smooth",                   NULL },
+  { "ai/lb:sine-waves",              NULL },
+  { "ai/lb:gradient",                NULL },
+  { "ai/lb:smooth-gradient",         NULL },
+  { "grok:polka-dots",               NULL },
+  { "grok:zebra-stripes",            NULL },
+  { "grok:tentacles",                NULL },
+  { "grok:hawaiian-flowers",         NULL },
+  { "grok:hawaiian-flowers-overlay", NULL },
+  { "grok:hawaiian-flowers-solid",   NULL },
+  { "grok:shaded-flowers",           NULL },
+  { "grok:color-cubes",              NULL },
+  { "grok:candy-spiral",             NULL },
+  { "grok:vibrance",                 NULL },
+  { "boy:pango-markup",              configure_pango_markup },
+};
+
+typedef struct
+{
+  const gchar *op;
+  gint         megapixels;
+  gint         level;
+  gint         threads;
+  gint         width;
+  gint         height;
+  gdouble      seconds;
+  gdouble      mpix_per_s;
+  gdouble      peak_rss_mb;
+  gdouble      tile_cache_hit_rate;
+} BenchResult;
+
+static gchar   *opt_ops;
+static gchar   *opt_sizes = "1,16,64";
+static gchar   *opt_levels = "0,1,2";
+static gint     opt_max_threads;
+static gint     opt_repeat = 3;
+static gchar   *opt_module_dir;
+static gchar   *opt_output;
+static gchar   *opt_baseline;
+static gdouble  opt_tolerance = 0.10;
+
+static const GOptionEntry entries[] =
+{
+  { "ops", 0, 0, G_OPTION_ARG_STRING, &opt_ops,
+    "Comma separated ops to run (default: all that are installed)", "OPS" },
+  { "sizes", 0, 0, G_OPTION_ARG_STRING, &opt_sizes,
+    "Comma separated canvas sizes in megapixels", "MP" },
+  { "levels", 0, 0, G_OPTION_ARG_STRING, &opt_levels,
+    "Comma separated mipmap levels", "LEVELS" },
+  { "max-threads", 0, 0, G_OPTION_ARG_INT, &opt_max_threads,
+    "Largest GEGL thread count, powers of two up to it are run", "N" },
+  { "repeat", 0, 0, G_OPTION_ARG_INT, &opt_repeat,
+    "Renders per case, the fastest is kept", "N" },
+  { "module-dir", 0, 0, G_OPTION_ARG_FILENAME, &opt_module_dir,
+    "Load op modules from this directory as well", "DIR" },
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &opt_output,
+    "Write the JSON report here instead of stdout", "FILE" },
+  { "baseline", 'b', 0, G_OPTION_ARG_FILENAME, &opt_baseline,
+    "Compare against an earlier JSON report", "FILE" },
+  { "tolerance", 0, 0, G_OPTION_ARG_DOUBLE, &opt_tolerance,
+    "Allowed slowdown against the baseline, as a fraction", "F" },
+  { NULL }
+};
+
+static GArray *
+parse_int_list (const gchar *list)
+{
+  GArray  *values = g_array_new (FALSE, FALSE, sizeof (gint));
+  gchar  **parts = g_strsplit (list, ",", -1);
+  gint     i;
+
+  for (i = 0; parts[i]; i++)
+    {
+      gint value = atoi (parts[i]);
+
+      if (value >= 0 && *g_strstrip (parts[i]))
+        g_array_append_val (values, value);
+    }
+  g_strfreev (parts);
+
+  return values;
+}
+
+/* Peak resident set since the last reset, in MiB.  Writing 5 to
+ * clear_refs restarts the high water mark so every case is measured on
+ * its own; elsewhere the process-wide peak is reported.
+ */
+static void
+reset_peak_rss (void)
+{
+  FILE *file = fopen ("/proc/self/clear_refs", "w");
+
+  if (file)
+    {
+      fputs ("5", file);
+      fclose (file);
+    }
+}
+
+static gdouble
+read_peak_rss_mb (void)
+{
+  FILE  *file = fopen ("/proc/self/status", "r");
+  gchar  line[256];
+  glong  kib = 0;
+
+  if (!file)
+    return 0.0;
+
+  while (fgets (line, sizeof (line), file))
+    if (sscanf (line, "VmHWM: %ld kB", &kib) == 1)
+      break;
+  fclose (file);
+
+  return kib / 1024.0;
+}
+
+/* checkerboard -> op -> crop, or op -> crop for ops without an input */
+static GeglNode *
+build_graph (GeglNode            *graph,
+             const BenchOp       *bench_op,
+             const GeglRectangle *canvas)
+{
+  GeglNode *op = gegl_node_new_child (graph, "operation", bench_op->name, NULL);
+  GeglNode *crop = gegl_node_new_child (graph,
+                                        "operation", "gegl:crop",
+                                        "x",         (gdouble) canvas->x,
+                                        "y",         (gdouble) canvas->y,
+                                        "width",     (gdouble) canvas->width,
+                                        "height",    (gdouble) canvas->height,
+                                        NULL);
+
+  if (bench_op->configure)
+    bench_op->configure (op);
+
+  if (gegl_node_has_pad (op, "input"))
+    {
+      GeglNode *source = gegl_node_new_child (graph,
+                                              "operation", "gegl:checkerboard",
+                                              "x",         64,
+                                              "y",         64,
+                                              NULL);
+
+      gegl_node_link_many (source, op, crop, NULL);
+    }
+  else
+    {
+      gegl_node_link (op, crop);
+    }
+
+  /* Keep the op from answering repeats out of its own cache */
+  g_object_set (op, "dont-cache", TRUE, NULL);
+
+  return crop;
+}
+
+/* Seconds for one render of the canvas at mipmap level, read back in
+ * bands so 64 MP cases don't need a full-size output buffer.
+ */
+static gdouble
+render (GeglNode            *sink,
+        const GeglRectangle *canvas,
+        gint                 level,
+        gfloat              *band)
+{
+  gdouble scale = 1.0 / (1 << level);
+  gint    width = canvas->width >> level;
+  gint    height = canvas->height >> level;
+  gint64  start = g_get_monotonic_time ();
+  gint    y;
+
+  for (y = 0; y < height; y += BENCH_BAND_ROWS)
+    {
+      GeglRectangle roi = { 0, y, width, MIN (BENCH_BAND_ROWS, height - y) };
+
+      gegl_node_blit (sink, scale, &roi, babl_format ("RGBA float"),
+                      band, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+    }
+
+  return (g_get_monotonic_time () - start) / (gdouble) G_USEC_PER_SEC;
+}
+
+static gdouble
+tile_cache_hit_rate (void)
+{
+  gint hits = 0;
+  gint misses = 0;
+
+  g_object_get (gegl_stats (),
+                "tile-cache-hits",   &hits,
+                "tile-cache-misses", &misses,
+                NULL);
+
+  return hits + misses > 0 ? hits / (gdouble) (hits + misses) : 0.0;
+}
+
+static void
+run_op (const BenchOp *bench_op,
+        GArray        *sizes,
+        GArray        *levels,
+        GArray        *threads,
+        GArray        *results)
+{
+  guint s, l, t;
+
+  for (s = 0; s < sizes->len; s++)
+    {
+      gint          mp = g_array_index (sizes, gint, s);
+      gint          side = (gint) (1024 * sqrt (mp));
+      GeglRectangle canvas = { 0, 0, side, side };
+      GeglNode     *graph = gegl_node_new ();
+      GeglNode     *sink = build_graph (graph, bench_op, &canvas);
+      gfloat       *band = g_new (gfloat, (gsize) side * BENCH_BAND_ROWS * 4);
+
+      for (l = 0; l < levels->len; l++)
+        for (t = 0; t < threads->len; t++)
+          {
+            BenchResult result = { 0, };
+            gdouble     best = G_MAXDOUBLE;
+            gint        r;
+
+            result.op = bench_op->name;
+            result.megapixels = mp;
+            result.level = g_array_index (levels, gint, l);
+            result.threads = g_array_index (threads, gint, t);
+            result.width = side >> result.level;
+            result.height = side >> result.level;
+
+            g_object_set (gegl_config (), "threads", result.threads, NULL);
+            reset_peak_rss ();
+            gegl_reset_stats ();
+
+            for (r = 0; r < MAX (opt_repeat, 1); r++)
+              best = MIN (best, render (sink, &canvas, result.level, band));
+
+            result.seconds = best;
+            result.mpix_per_s = (gdouble) result.width * result.height / 1e6 / best;
+            result.peak_rss_mb = read_peak_rss_mb ();
+            result.tile_cache_hit_rate = tile_cache_hit_rate ();
+            g_array_append_val (results, result);
+
+            g_printerr ("%-32s %3d MP  level %d  %2d threads  %9.2f Mpix/s\n",
+                        result.op, mp, result.level, result.threads,
+                        result.mpix_per_s);
+          }
+
+      g_free (band);
+      g_object_unref (graph);
+    }
+}
+
+static gchar *
+result_key (const gchar *op,
+            gint         megapixels,
+            gint         level,
+            gint         threads)
+{
+  return g_strdup_printf ("%s/%d/%d/%d", op, megapixels, level, threads);
+}
+
+/* Mpix/s of every case in an earlier report, keyed by result_key () */
+static GHashTable *
+load_baseline (const gchar *path)
+{
+  JsonParser *parser = json_parser_new ();
+  GHashTable *baseline = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  GError     *error = NULL;
+  JsonArray  *cases;
+  guint       i;
+
+  if (!json_parser_load_from_file (parser, path, &error))
+    {
+      g_printerr ("grok-bench: could not read baseline '%s': %s\n", path, error->message);
+      g_error_free (error);
+      g_object_unref (parser);
+      g_hash_table_unref (baseline);
+      return NULL;
+    }
+
+  cases = json_object_get_array_member (json_node_get_object (json_parser_get_root (parser)),
+                                        "results");
+  for (i = 0; i < json_array_get_length (cases); i++)
+    {
+      JsonObject *entry = json_array_get_object_element (cases, i);
+      gdouble    *mpix = g_new (gdouble, 1);
+
+      *mpix = json_object_get_double_member (entry, "mpix_per_s");
+      g_hash_table_insert (baseline,
+                           result_key (json_object_get_string_member (entry, "op"),
+                                       json_object_get_int_member (entry, "megapixels"),
+                                       json_object_get_int_member (entry, "level"),
+                                       json_object_get_int_member (entry, "threads")),
+                           mpix);
+    }
+
+  g_object_unref (parser);
+  return baseline;
+}
+
+/* Builds the report, annotating each case with its baseline when there
+ * is one.  Returns the number of cases slower than the tolerance allows.
+ */
+static gint
+write_report (GArray     *results,
+              GHashTable *baseline)
+{
+  JsonBuilder   *builder = json_builder_new ();
+  JsonGenerator *generator;
+  JsonNode      *root;
+  gchar         *version;
+  gint           major, minor, micro;
+  gint           regressions = 0;
+  guint          i;
+
+  gegl_get_version (&major, &minor, &micro);
+  version = g_strdup_printf ("%d.%d.%d", major, minor, micro);
+
+  json_builder_begin_object (builder);
+
+  json_builder_set_member_name (builder, "machine");
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "processors");
+  json_builder_add_int_value (builder, g_get_num_processors ());
+  json_builder_set_member_name (builder, "gegl");
+  json_builder_add_string_value (builder, version);
+  json_builder_end_object (builder);
+
+  json_builder_set_member_name (builder, "results");
+  json_builder_begin_array (builder);
+
+  for (i = 0; i < results->len; i++)
+    {
+      BenchResult *result = &g_array_index (results, BenchResult, i);
+      gdouble     *base = NULL;
+
+      json_builder_begin_object (builder);
+      json_builder_set_member_name (builder, "op");
+      json_builder_add_string_value (builder, result->op);
+      json_builder_set_member_name (builder, "megapixels");
+      json_builder_add_int_value (builder, result->megapixels);
+      json_builder_set_member_name (builder, "level");
+      json_builder_add_int_value (builder, result->level);
+      json_builder_set_member_name (builder, "threads");
+      json_builder_add_int_value (builder, result->threads);
+      json_builder_set_member_name (builder, "width");
+      json_builder_add_int_value (builder, result->width);
+      json_builder_set_member_name (builder, "height");
+      json_builder_add_int_value (builder, result->height);
+      json_builder_set_member_name (builder, "seconds");
+      json_builder_add_double_value (builder, result->seconds);
+      json_builder_set_member_name (builder, "mpix_per_s");
+      json_builder_add_double_value (builder, result->mpix_per_s);
+      json_builder_set_member_name (builder, "peak_rss_mb");
+      json_builder_add_double_value (builder, result->peak_rss_mb);
+      json_builder_set_member_name (builder, "tile_cache_hit_rate");
+      json_builder_add_double_value (builder, result->tile_cache_hit_rate);
+
+      if (baseline)
+        {
+          gchar *key = result_key (result->op, result->megapixels,
+                                   result->level, result->threads);
+
+          base = g_hash_table_lookup (baseline, key);
+          g_free (key);
+        }
+
+      if (base && *base > 0.0)
+        {
+          gdouble  change = result->mpix_per_s / *base - 1.0;
+          gboolean regressed = change < -opt_tolerance;
+
+          json_builder_set_member_name (builder, "baseline_mpix_per_s");
+          json_builder_add_double_value (builder, *base);
+          json_builder_set_member_name (builder, "change");
+          json_builder_add_double_value (builder, change);
+          json_builder_set_member_name (builder, "regression");
+          json_builder_add_boolean_value (builder, regressed);
+
+          if (regressed)
+            {
+              g_printerr ("REGRESSION %s %d MP level %d %d threads: "
+                          "%.2f Mpix/s against %.2f (%+.1f%%)\n",
+                          result->op, result->megapixels, result->level,
+                          result->threads, result->mpix_per_s, *base,
+                          change * 100.0);
+              regressions++;
+            }
+        }
+
+      json_builder_end_object (builder);
+    }
+
+  json_builder_end_array (builder);
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  generator = json_generator_new ();
+  json_generator_set_root (generator, root);
+  json_generator_set_pretty (generator, TRUE);
+
+  if (opt_output)
+    {
+      GError *error = NULL;
+
+      if (!json_generator_to_file (generator, opt_output, &error))
+        {
+          g_printerr ("grok-bench: could not write '%s': %s\n", opt_output, error->message);
+          g_error_free (error);
+        }
+    }
+  else
+    {
+      gchar *json = json_generator_to_data (generator, NULL);
+
+      puts (json);
+      g_free (json);
+    }
+
+  json_node_unref (root);
+  g_free (version);
+  g_object_unref (generator);
+  g_object_unref (builder);
+
+  return regressions;
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  GOptionContext *context = g_option_context_new ("- benchmark the grok GEGL ops");
+  GError         *error = NULL;
+  GArray         *sizes, *levels, *threads, *results;
+  GHashTable     *baseline = NULL;
+  gchar         **selected = NULL;
+  gint            regressions;
+  gint            n;
+  guint           i;
+
+  gegl_init (&argc, &argv);
+
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("grok-bench: %s\n", error->message);
+      return 2;
+    }
+  g_option_context_free (context);
+
+  if (opt_module_dir)
+    gegl_load_module_directory (opt_module_dir);
+
+  g_object_set (gegl_config (), "mipmap-rendering", TRUE, NULL);
+
+  if (opt_baseline && !(baseline = load_baseline (opt_baseline)))
+    return 2;
+
+  sizes = parse_int_list (opt_sizes);
+  levels = parse_int_list (opt_levels);
+  threads = g_array_new (FALSE, FALSE, sizeof (gint));
+  if (opt_max_threads <= 0)
+    opt_max_threads = g_get_num_processors ();
+  for (n = 1; n < opt_max_threads; n *= 2)
+    g_array_append_val (threads, n);
+  g_array_append_val (threads, opt_max_threads);
+
+  results = g_array_new (FALSE, FALSE, sizeof (BenchResult));
+  if (opt_ops)
+    selected = g_strsplit (opt_ops, ",", -1);
+
+  for (i = 0; i < G_N_ELEMENTS (bench_ops); i++)
+    {
+      const BenchOp *bench_op = &bench_ops[i];
+
+      if (selected && !g_strv_contains ((const gchar * const *) selected, bench_op->name))
+        continue;
+
+      if (!gegl_has_operation (bench_op->name))
+        {
+          g_printerr ("grok-bench: %s is not installed, skipping\n", bench_op->name);
+          continue;
+        }
+
+      run_op (bench_op, sizes, levels, threads, results);
+    }
+
+  regressions = write_report (results, baseline);
+
+  if (baseline)
+    g_hash_table_unref (baseline);
+  g_strfreev (selected);
+  g_array_free (results, TRUE);
+  g_array_free (threads, TRUE);
+  g_array_free (levels, TRUE);
+  g_array_free (sizes, TRUE);
+
+  gegl_exit ();
+
+  return regressions ? 1 : 0;
+}
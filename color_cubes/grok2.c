@@ -1,6 +1,8 @@
 #include "config.h"
 #include <glib/gi18n-lib.h>
 #include <math.h>
+#include <string.h>
+#include "grok-noise.h"
 
 #ifdef GEGL_PROPERTIES
 
@@ -27,10 +29,12 @@ property_seed    (seed, _("Color Seed"), rand)
 #else
 
 #define GEGL_OP_FILTER
-#define GEGL_OP_NAME     grok2
-#define GEGL_OP_C_SOURCE grok2.c
+#define GEGL_OP_NAME     color_cubes
+#define GEGL_OP_C_SOURCE color_cubes/grok2.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
+#include "grok-kernel.h"
 
 static void
 prepare (GeglOperation *operation)
@@ -48,6 +52,160 @@ get_bounding_box (GeglOperation *operation)
   return gegl_rectangle_infinite_plane();
 }
 
+/* Define Tetris color palette (RGB values) */
+static const gfloat colors[][3] = {
+  {1.0, 0.0, 0.0}, /* Red */
+  {0.0, 1.0, 0.0}, /* Green */
+  {0.0, 0.0, 1.0}, /* Blue */
+  {1.0, 1.0, 0.0}, /* Yellow */
+  {0.0, 1.0, 1.0}, /* Cyan */
+  {1.0, 0.0, 1.0}, /* Magenta */
+  {1.0, 0.5, 0.0}  /* Orange */
+};
+#define NUM_COLORS G_N_ELEMENTS (colors)
+
+/* Grid and rotation, constant for a whole process() call */
+typedef struct
+{
+  gfloat  grid_size;
+  gfloat  half_size;
+  gdouble cos_a, sin_a;
+} CubeGrid;
+
+/* Whether (dx, dy) from the cell centre lies inside the rotated cube */
+static inline gboolean
+cube_covers (const CubeGrid *grid, gfloat dx, gfloat dy)
+{
+  gfloat rotated_dx = dx * grid->cos_a - dy * grid->sin_a;
+  gfloat rotated_dy = dx * grid->sin_a + dy * grid->cos_a;
+
+  return fabs(rotated_dx) < grid->half_size && fabs(rotated_dy) < grid->half_size;
+}
+
+/* Narrows (*lo, *hi) to the dx where |dx * p + q| < h */
+static void
+cube_slab (gdouble p, gdouble q, gdouble h, gdouble *lo, gdouble *hi)
+{
+  gdouble a, b;
+
+  if (p == 0.0)
+  {
+    if (fabs(q) >= h)
+      *hi = *lo;
+    return;
+  }
+
+  a = (-h - q) / p;
+  b = (h - q) / p;
+  *lo = MAX (*lo, MIN (a, b));
+  *hi = MIN (*hi, MAX (a, b));
+}
+
+/* Pixels outside every cube: transparent input becomes opaque black */
+static void
+cube_copy (const gfloat *in, gfloat *out, gint n)
+{
+  for (gint i = 0; i < n; i++, in += 4, out += 4)
+  {
+    if (in[3] == 0.0)
+    {
+      out[0] = out[1] = out[2] = 0.0;
+      out[3] = 1.0;
+    }
+    else
+    {
+      memcpy (out, in, 4 * sizeof (gfloat));
+    }
+  }
+}
+
+/* Pixels inside a cube take its colour and keep the input alpha */
+static void
+cube_fill (const gfloat *in, gfloat *out, gint n, const gfloat *color)
+{
+  for (gint i = 0; i < n; i++, in += 4, out += 4)
+  {
+    out[0] = color[0];
+    out[1] = color[1];
+    out[2] = color[2];
+    out[3] = in[3] == 0.0 ? 1.0 : in[3];
+  }
+}
+
+/* One output row: walk the grid cells it crosses and fill the span each
+ * cube covers, copying the input around it.  The span comes from the
+ * rotated square's slabs and is then snapped to the per-pixel test, so
+ * coverage is exactly that of evaluating every pixel.
+ */
+GROK_KERNEL
+static void
+cube_row (const CubeGrid *grid,
+          guint32         seed,
+          const gfloat   *in,
+          gfloat         *out,
+          gint            x0,
+          gint            y,
+          gint            width)
+{
+  gfloat grid_size = grid->grid_size;
+  gfloat grid_y = (gfloat) y / grid_size;
+  gint   iy = (gint)floor(grid_y);
+  gfloat center_y = (floor(grid_y) + 0.5) * grid_size;
+  gfloat dy = y - center_y;
+  gint   x = 0;
+
+  while (x < width)
+  {
+    gfloat grid_x = (gfloat) (x0 + x) / grid_size;
+    gint   ix = (gint)floor(grid_x);
+    gfloat center_x = (floor(grid_x) + 0.5) * grid_size;
+    gdouble lo_dx = -G_MAXDOUBLE, hi_dx = G_MAXDOUBLE;
+    gint   end, lo, hi;
+
+    /* First pixel of the next cell */
+    end = CLAMP ((gint)ceil((ix + 1) * (gdouble) grid_size) - x0, x + 1, width);
+    while (end > x + 1 && floor((gfloat) (x0 + end - 1) / grid_size) > ix)
+      end--;
+    while (end < width && floor((gfloat) (x0 + end) / grid_size) == ix)
+      end++;
+
+    /* Columns whose rotated offset lies inside the cube on both axes */
+    cube_slab (grid->cos_a, -dy * grid->sin_a, grid->half_size, &lo_dx, &hi_dx);
+    cube_slab (grid->sin_a, dy * grid->cos_a, grid->half_size, &lo_dx, &hi_dx);
+
+    lo = hi = x;
+    if (lo_dx < hi_dx)
+    {
+      lo = CLAMP (ceil(center_x + lo_dx) - x0, x, end);
+      hi = CLAMP (ceil(center_x + hi_dx) - x0, lo, end);
+    }
+    while (lo > x && cube_covers (grid, (gfloat) (x0 + lo - 1) - center_x, dy))
+      lo--;
+    while (lo < hi && !cube_covers (grid, (gfloat) (x0 + lo) - center_x, dy))
+      lo++;
+    if (hi < lo)
+      hi = lo;
+    while (hi < end && cube_covers (grid, (gfloat) (x0 + hi) - center_x, dy))
+      hi++;
+    while (hi > lo && !cube_covers (grid, (gfloat) (x0 + hi - 1) - center_x, dy))
+      hi--;
+
+    cube_copy (in + x * 4, out + x * 4, lo - x);
+    if (hi > lo)
+    {
+      /* Counter-based hash of the cell, identical for every tile and thread */
+      const gfloat *color = colors[grok_hash2 (ix, iy, seed) % NUM_COLORS];
+
+      cube_fill (in + lo * 4, out + lo * 4, hi - lo, color);
+    }
+    cube_copy (in + hi * 4, out + hi * 4, end - hi);
+
+    x = end;
+  }
+}
+
+static GrokTraceOp *trace_op;
+
 static gboolean
 process (GeglOperation       *operation,
          GeglBuffer          *input,
@@ -58,18 +216,17 @@ process (GeglOperation       *operation,
   GeglProperties *o = GEGL_PROPERTIES(operation);
   GeglBufferIterator *iter;
   const Babl *format = babl_format("RGBA float");
+  CubeGrid grid;
+  GrokTraceSpan span;
+
+  grok_trace_begin (&span, trace_op, roi, level);
 
-  /* Define Tetris color palette (RGB values) */
-  gfloat colors[][3] = {
-    {1.0, 0.0, 0.0}, /* Red */
-    {0.0, 1.0, 0.0}, /* Green */
-    {0.0, 0.0, 1.0}, /* Blue */
-    {1.0, 1.0, 0.0}, /* Yellow */
-    {0.0, 1.0, 1.0}, /* Cyan */
-    {1.0, 0.0, 1.0}, /* Magenta */
-    {1.0, 0.5, 0.0}  /* Orange */
-  };
-  gint num_colors = 7;
+  /* Calculate grid position and rotation once per call */
+  gfloat angle = o->rotation * G_PI / 180.0;
+  grid.grid_size = o->cube_size * o->spacing;
+  grid.half_size = o->cube_size * 0.5;
+  grid.cos_a = cos(angle);
+  grid.sin_a = sin(angle);
 
   iter = gegl_buffer_iterator_new(output, roi, level, format,
                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 2);
@@ -80,88 +237,18 @@ process (GeglOperation       *operation,
   {
     gfloat *in_data = (gfloat *)iter->items[1].data;
     gfloat *out_data = (gfloat *)iter->items[0].data;
-    gint width = iter->items[0].roi.width;
-    gint height = iter->items[0].roi.height;
-    gint x, y;
+    GeglRectangle *chunk = &iter->items[0].roi;
+    gint y;
 
-    for (y = 0; y < height; y++)
-    {
-      for (x = 0; x < width; x++)
-      {
-        gint pixel_idx = (y * width + x) * 4;
-        gfloat pixel_x = x + iter->items[0].roi.x;
-        gfloat pixel_y = y + iter->items[0].roi.y;
-
-        /* Calculate grid position */
-        gfloat grid_size = o->cube_size * o->spacing;
-        gfloat grid_x = pixel_x / grid_size;
-        gfloat grid_y = pixel_y / grid_size;
-
-        /* Find nearest cube center */
-        gfloat center_x = (floor(grid_x) + 0.5) * grid_size;
-        gfloat center_y = (floor(grid_y) + 0.5) * grid_size;
-
-        /* Compute distance from cube center */
-        gfloat dx = pixel_x - center_x;
-        gfloat dy = pixel_y - center_y;
-
-        /* Apply rotation */
-        gfloat angle = o->rotation * G_PI / 180.0;
-        gfloat rotated_dx = dx * cos(angle) - dy * sin(angle);
-        gfloat rotated_dy = dx * sin(angle) + dy * cos(angle);
-
-        /* Check if pixel is inside a cube */
-        gfloat cube_half_size = o->cube_size * 0.5;
-        if (fabs(rotated_dx) < cube_half_size && fabs(rotated_dy) < cube_half_size)
-        {
-          /* Assign color based on cube position and seed */
-          gint ix = (gint)floor(grid_x);
-          gint iy = (gint)floor(grid_y);
-          /* Simple hash combining seed, ix, iy */
-          guint hash = o->seed + ix * 73856093 + iy * 19349663;
-          gint color_idx = (hash % num_colors + num_colors) % num_colors;
-          gfloat *color = colors[color_idx];
-
-          if (in_data[pixel_idx + 3] == 0.0)
-          {
-            /* Transparent input: black background, colored cube */
-            out_data[pixel_idx + 0] = color[0]; /* Red */
-            out_data[pixel_idx + 1] = color[1]; /* Green */
-            out_data[pixel_idx + 2] = color[2]; /* Blue */
-            out_data[pixel_idx + 3] = 1.0;      /* Opaque */
-          }
-          else
-          {
-            /* Non-transparent input: blend cube with input */
-            out_data[pixel_idx + 0] = in_data[pixel_idx + 0] * (1.0 - 1.0) + color[0];
-            out_data[pixel_idx + 1] = in_data[pixel_idx + 1] * (1.0 - 1.0) + color[1];
-            out_data[pixel_idx + 2] = in_data[pixel_idx + 2] * (1.0 - 1.0) + color[2];
-            out_data[pixel_idx + 3] = in_data[pixel_idx + 3];
-          }
-        }
-        else
-        {
-          if (in_data[pixel_idx + 3] == 0.0)
-          {
-            /* Transparent input: black background */
-            out_data[pixel_idx + 0] = 0.0;
-            out_data[pixel_idx + 1] = 0.0;
-            out_data[pixel_idx + 2] = 0.0;
-            out_data[pixel_idx + 3] = 1.0;
-          }
-          else
-          {
-            /* Copy input pixel */
-            out_data[pixel_idx + 0] = in_data[pixel_idx + 0];
-            out_data[pixel_idx + 1] = in_data[pixel_idx + 1];
-            out_data[pixel_idx + 2] = in_data[pixel_idx + 2];
-            out_data[pixel_idx + 3] = in_data[pixel_idx + 3];
-          }
-        }
-      }
-    }
+    for (y = 0; y < chunk->height; y++)
+      cube_row (&grid, o->seed,
+                in_data + (gsize) y * chunk->width * 4,
+                out_data + (gsize) y * chunk->width * 4,
+                chunk->x, chunk->y + y, chunk->width);
   }
 
+  grok_trace_end (&span, (guint64) roi->width * roi->height);
+
   return TRUE;
 }
 
@@ -179,12 +266,14 @@ gegl_op_class_init (GeglOpClass *klass)
   operation_class->get_bounding_box = get_bounding_box;
 
   gegl_operation_class_set_keys (operation_class,
-    "name",        "gegl:grok2",
+    "name",        "grok:color-cubes",
     "title",       _("Multicolor Cubes"),
     "categories",  "render",
     "reference-hash", "cub3dr0p",
     "description", _("Renders a grid of multi-colored Tetris-like cubes tiling the entire canvas with randomized colors"),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
@@ -0,0 +1,1252 @@
+/* grok-diffuse.h
+ *
+ * Copyright (C) 2006-2013 Øyvind Kolås, Nicolas Robidoux, Geert Jordaens, 
+ * Sven Neumann, Martin Nordholts, Richard D. Worth, Mukund Sivaraman, 
+ * and others
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The anisotropic diffusion behind gegl:smooth, shared with the ops that
+ * start with it.
+ *
+ * The including op declares GROK_DIFFUSE_PROPERTIES from
+ * grok-properties.h, includes this after gegl-op.h, calls diffuse_init
+ * from class_init and pads its requests by get_halo.  diffuse_region does
+ * the CPU side of a whole process call and passes every finished row to
+ * an optional callback, so the caller can still work on it before it
+ * reaches the output.
+ */
+
+#ifndef __GROK_DIFFUSE_H__
+#define __GROK_DIFFUSE_H__
+
+#include <math.h>
+#include <string.h>
+#include "grok-trace.h"
+
+/* A step at mipmap level n spans 2^n full resolution pixels, so the same
+ * diffusion time takes 4^n times fewer of them.
+ */
+static gint
+iterations_at_level (gint iterations,
+                     gint level)
+{
+  return MAX (1, (iterations + (1 << (2 * level)) / 2) >> (2 * level));
+}
+
+static gint
+pyramid_iterations (gint iterations,
+                    gint levels)
+{
+  return MAX (1, (iterations + (1 << (2 * levels)) - 1) >> (2 * levels));
+}
+
+/* The semi-implicit solver covers iterations x delta_t in steps of at
+ * most AOS_MAX_TAU; it stays stable beyond that, but the splitting error
+ * starts to show as axis aligned streaks.
+ */
+#define AOS_MAX_TAU       3.0f
+#define AOS_HALO_PER_STEP 45
+
+static gint
+aos_steps (gint   iterations,
+           gfloat delta_t)
+{
+  return MAX (1, (gint) ceilf (iterations * delta_t / AOS_MAX_TAU));
+}
+
+/* How far input can influence output after diffusing for iterations.
+ * Every explicit iteration reads the 4-neighbourhood, so after n of them
+ * a pixel depends on input up to n pixels away.  An implicit step couples
+ * whole rows and columns, but the influence falls off geometrically.  The
+ * coefficients are normalised by the summed conductance, so the worst case
+ * is a run of pixels that only conduct along the row: with tau at
+ * AOS_MAX_TAU and alpha x strength at its maximum of 5 the off-diagonal is
+ * 15 against a diagonal of 31.  Influence then decays by (31 - sqrt 61) / 30,
+ * about 0.773 per pixel, and is below 1e-5 after AOS_HALO_PER_STEP pixels.
+ */
+static gint
+diffusion_reach (GeglProperties *o,
+                 gint            iterations)
+{
+  if (o->solver == SMOOTH_SOLVER_AOS)
+    return aos_steps (iterations, o->delta_t) * AOS_HALO_PER_STEP;
+  return iterations;
+}
+
+/* The margin a tile needs.  In pyramid mode each coarse step reaches a
+ * whole cell, and the box filter, upsampling and refinement steps add a
+ * few cells on top.
+ */
+static gint
+get_halo (GeglProperties *o,
+          gint            level)
+{
+  gint iterations = iterations_at_level (o->iterations, level);
+
+  if (o->pyramid_levels == 0)
+    return diffusion_reach (o, iterations);
+  return (diffusion_reach (o, pyramid_iterations (iterations, o->pyramid_levels)) + 3)
+         << o->pyramid_levels;
+}
+
+static inline gfloat
+conductance (gfloat gradient, gfloat kappa)
+{
+  gfloat g = gradient / kappa;
+  return expf (-g * g); /* Gaussian conductance for edge-preserving smoothing */
+}
+
+typedef struct
+{
+  gfloat kappa;
+  gfloat alpha_strength;
+  gfloat delta_t;
+} DiffuseParams;
+
+/* The scratch regions are planar: four width x height planes (R, G, B, A)
+ * at a distance of plane floats, so one vector register holds the same
+ * channel of several neighbouring pixels.
+ */
+
+/* One pixel of an explicit diffusion step.  Neighbours outside the region
+ * are treated as missing, which is what the image border looks like.
+ */
+static inline void
+diffuse_pixel (const gfloat        *src,
+               gfloat              *dst,
+               gsize                plane,
+               gint                 width,
+               gint                 height,
+               gint                 x,
+               gint                 y,
+               const DiffuseParams *p)
+{
+  const gsize   offset = (gsize) y * width + x;
+  const gfloat *center = src + offset;
+  gfloat sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  gfloat weights[4] = {0.0f};
+  gfloat gradients[4][4] = {{0.0f}};
+  gfloat weight_sum;
+  gint j;
+
+  /* Compute gradients in four directions (N, S, E, W) */
+  if (x > 0) /* West */
+    {
+      for (j = 0; j < 4; j++)
+        gradients[0][j] = center[j * plane - 1] - center[j * plane];
+      weights[0] = conductance (fabsf (gradients[0][0]), p->kappa);
+    }
+
+  if (x < width - 1) /* East */
+    {
+      for (j = 0; j < 4; j++)
+        gradients[1][j] = center[j * plane + 1] - center[j * plane];
+      weights[1] = conductance (fabsf (gradients[1][0]), p->kappa);
+    }
+
+  if (y > 0) /* North */
+    {
+      for (j = 0; j < 4; j++)
+        gradients[2][j] = center[j * plane - width] - center[j * plane];
+      weights[2] = conductance (fabsf (gradients[2][0]), p->kappa);
+    }
+
+  if (y < height - 1) /* South */
+    {
+      for (j = 0; j < 4; j++)
+        gradients[3][j] = center[j * plane + width] - center[j * plane];
+      weights[3] = conductance (fabsf (gradients[3][0]), p->kappa);
+    }
+
+  /* Update pixel values */
+  weight_sum = weights[0] + weights[1] + weights[2] + weights[3];
+  if (weight_sum > 1e-6f)
+    {
+      gfloat w = p->alpha_strength / weight_sum;
+      for (j = 0; j < 4; j++)
+        {
+          sum[j] = w * (weights[0] * gradients[0][j] +
+                        weights[1] * gradients[1][j] +
+                        weights[2] * gradients[2][j] +
+                        weights[3] * gradients[3][j]);
+          sum[j] = CLAMP (sum[j], -2.0f, 2.0f); /* Wider clamp for stronger effect */
+        }
+    }
+
+  for (j = 0; j < 4; j++)
+    {
+      gfloat value = center[j * plane] + p->delta_t * sum[j];
+      dst[offset + j * plane] = CLAMP (value, 0.0f, 1.0f);
+    }
+}
+
+/* Vector kernels for the interior [1, width - 1) of row y, where all four
+ * neighbours exist and the step needs no branches.  The last vector is
+ * moved back to end at width - 1 and recomputes a few pixels instead of
+ * falling back to a scalar tail.  They return FALSE when the row is too
+ * narrow for a single vector.
+ *
+ * The conductance uses exp (x) = 2^i * 2^f with i = round (x * log2 (e))
+ * and a degree 6 polynomial for 2^f on [-0.5, 0.5], good to about one
+ * float ulp; x is never below -1 here, the clamp only keeps 2^i a normal.
+ */
+typedef gboolean (* DiffuseRowFunc) (const gfloat        *src,
+                                     gfloat              *dst,
+                                     gsize                plane,
+                                     gint                 width,
+                                     gint                 y,
+                                     const DiffuseParams *p);
+
+static DiffuseRowFunc diffuse_row = NULL;
+
+#define EXP2_C0 1.0f
+#define EXP2_C1 0.693147181f
+#define EXP2_C2 0.240226507f
+#define EXP2_C3 0.0555041087f
+#define EXP2_C4 0.00961812911f
+#define EXP2_C5 0.00133335581f
+#define EXP2_C6 0.000154035304f
+
+#ifdef ARCH_X86_64
+#include <immintrin.h>
+
+__attribute__ ((target ("avx2,fma")))
+static inline __m256
+fast_exp_avx2 (__m256 x)
+{
+  __m256  t = _mm256_max_ps (_mm256_mul_ps (x, _mm256_set1_ps (1.44269504f)),
+                             _mm256_set1_ps (-126.0f));
+  __m256  i = _mm256_round_ps (t, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256  f = _mm256_sub_ps (t, i);
+  __m256  r = _mm256_set1_ps (EXP2_C6);
+  __m256i e;
+
+  r = _mm256_fmadd_ps (r, f, _mm256_set1_ps (EXP2_C5));
+  r = _mm256_fmadd_ps (r, f, _mm256_set1_ps (EXP2_C4));
+  r = _mm256_fmadd_ps (r, f, _mm256_set1_ps (EXP2_C3));
+  r = _mm256_fmadd_ps (r, f, _mm256_set1_ps (EXP2_C2));
+  r = _mm256_fmadd_ps (r, f, _mm256_set1_ps (EXP2_C1));
+  r = _mm256_fmadd_ps (r, f, _mm256_set1_ps (EXP2_C0));
+
+  e = _mm256_slli_epi32 (_mm256_add_epi32 (_mm256_cvtps_epi32 (i),
+                                           _mm256_set1_epi32 (127)), 23);
+  return _mm256_mul_ps (r, _mm256_castsi256_ps (e));
+}
+
+__attribute__ ((target ("avx2,fma")))
+static gboolean
+diffuse_row_avx2 (const gfloat        *src,
+                  gfloat              *dst,
+                  gsize                plane,
+                  gint                 width,
+                  gint                 y,
+                  const DiffuseParams *p)
+{
+  const __m256 scale_x = _mm256_set1_ps (-1.0f / (p->kappa * p->kappa));
+  const __m256 strength = _mm256_set1_ps (p->alpha_strength);
+  const __m256 delta_t = _mm256_set1_ps (p->delta_t);
+  const __m256 epsilon = _mm256_set1_ps (1e-6f);
+  const __m256 lo = _mm256_set1_ps (-2.0f);
+  const __m256 hi = _mm256_set1_ps (2.0f);
+  const __m256 zero = _mm256_setzero_ps ();
+  const __m256 one = _mm256_set1_ps (1.0f);
+  const gsize  row = (gsize) y * width;
+  gint x;
+
+  if (width - 2 < 8)
+    return FALSE;
+
+  for (x = 1; x < width - 1; x += 8)
+    {
+      const gsize   offset = row + MIN (x, width - 9);
+      const gfloat *center = src + offset;
+      __m256 c  = _mm256_loadu_ps (center);
+      __m256 gw = _mm256_sub_ps (_mm256_loadu_ps (center - 1), c);
+      __m256 ge = _mm256_sub_ps (_mm256_loadu_ps (center + 1), c);
+      __m256 gn = _mm256_sub_ps (_mm256_loadu_ps (center - width), c);
+      __m256 gs = _mm256_sub_ps (_mm256_loadu_ps (center + width), c);
+      __m256 kw = fast_exp_avx2 (_mm256_mul_ps (_mm256_mul_ps (gw, gw), scale_x));
+      __m256 ke = fast_exp_avx2 (_mm256_mul_ps (_mm256_mul_ps (ge, ge), scale_x));
+      __m256 kn = fast_exp_avx2 (_mm256_mul_ps (_mm256_mul_ps (gn, gn), scale_x));
+      __m256 ks = fast_exp_avx2 (_mm256_mul_ps (_mm256_mul_ps (gs, gs), scale_x));
+      __m256 weight_sum = _mm256_add_ps (_mm256_add_ps (kw, ke),
+                                         _mm256_add_ps (kn, ks));
+      __m256 w = _mm256_and_ps (_mm256_cmp_ps (weight_sum, epsilon, _CMP_GT_OQ),
+                                _mm256_div_ps (strength, weight_sum));
+      gint j;
+
+      for (j = 0; j < 4; j++)
+        {
+          const gfloat *cj = center + j * plane;
+          __m256 v = _mm256_loadu_ps (cj);
+          __m256 sum;
+
+          sum = _mm256_mul_ps (kw, _mm256_sub_ps (_mm256_loadu_ps (cj - 1), v));
+          sum = _mm256_fmadd_ps (ke, _mm256_sub_ps (_mm256_loadu_ps (cj + 1), v), sum);
+          sum = _mm256_fmadd_ps (kn, _mm256_sub_ps (_mm256_loadu_ps (cj - width), v), sum);
+          sum = _mm256_fmadd_ps (ks, _mm256_sub_ps (_mm256_loadu_ps (cj + width), v), sum);
+          sum = _mm256_min_ps (_mm256_max_ps (_mm256_mul_ps (w, sum), lo), hi);
+
+          v = _mm256_fmadd_ps (delta_t, sum, v);
+          v = _mm256_min_ps (_mm256_max_ps (v, zero), one);
+          _mm256_storeu_ps (dst + offset + j * plane, v);
+        }
+    }
+
+  return TRUE;
+}
+
+__attribute__ ((target ("sse4.1")))
+static inline __m128
+fast_exp_sse4 (__m128 x)
+{
+  __m128  t = _mm_max_ps (_mm_mul_ps (x, _mm_set1_ps (1.44269504f)),
+                          _mm_set1_ps (-126.0f));
+  __m128  i = _mm_round_ps (t, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m128  f = _mm_sub_ps (t, i);
+  __m128  r = _mm_set1_ps (EXP2_C6);
+  __m128i e;
+
+  r = _mm_add_ps (_mm_mul_ps (r, f), _mm_set1_ps (EXP2_C5));
+  r = _mm_add_ps (_mm_mul_ps (r, f), _mm_set1_ps (EXP2_C4));
+  r = _mm_add_ps (_mm_mul_ps (r, f), _mm_set1_ps (EXP2_C3));
+  r = _mm_add_ps (_mm_mul_ps (r, f), _mm_set1_ps (EXP2_C2));
+  r = _mm_add_ps (_mm_mul_ps (r, f), _mm_set1_ps (EXP2_C1));
+  r = _mm_add_ps (_mm_mul_ps (r, f), _mm_set1_ps (EXP2_C0));
+
+  e = _mm_slli_epi32 (_mm_add_epi32 (_mm_cvtps_epi32 (i),
+                                     _mm_set1_epi32 (127)), 23);
+  return _mm_mul_ps (r, _mm_castsi128_ps (e));
+}
+
+__attribute__ ((target ("sse4.1")))
+static gboolean
+diffuse_row_sse4 (const gfloat        *src,
+                  gfloat              *dst,
+                  gsize                plane,
+                  gint                 width,
+                  gint                 y,
+                  const DiffuseParams *p)
+{
+  const __m128 scale_x = _mm_set1_ps (-1.0f / (p->kappa * p->kappa));
+  const __m128 strength = _mm_set1_ps (p->alpha_strength);
+  const __m128 delta_t = _mm_set1_ps (p->delta_t);
+  const __m128 epsilon = _mm_set1_ps (1e-6f);
+  const __m128 lo = _mm_set1_ps (-2.0f);
+  const __m128 hi = _mm_set1_ps (2.0f);
+  const __m128 zero = _mm_setzero_ps ();
+  const __m128 one = _mm_set1_ps (1.0f);
+  const gsize  row = (gsize) y * width;
+  gint x;
+
+  if (width - 2 < 4)
+    return FALSE;
+
+  for (x = 1; x < width - 1; x += 4)
+    {
+      const gsize   offset = row + MIN (x, width - 5);
+      const gfloat *center = src + offset;
+      __m128 c  = _mm_loadu_ps (center);
+      __m128 gw = _mm_sub_ps (_mm_loadu_ps (center - 1), c);
+      __m128 ge = _mm_sub_ps (_mm_loadu_ps (center + 1), c);
+      __m128 gn = _mm_sub_ps (_mm_loadu_ps (center - width), c);
+      __m128 gs = _mm_sub_ps (_mm_loadu_ps (center + width), c);
+      __m128 kw = fast_exp_sse4 (_mm_mul_ps (_mm_mul_ps (gw, gw), scale_x));
+      __m128 ke = fast_exp_sse4 (_mm_mul_ps (_mm_mul_ps (ge, ge), scale_x));
+      __m128 kn = fast_exp_sse4 (_mm_mul_ps (_mm_mul_ps (gn, gn), scale_x));
+      __m128 ks = fast_exp_sse4 (_mm_mul_ps (_mm_mul_ps (gs, gs), scale_x));
+      __m128 weight_sum = _mm_add_ps (_mm_add_ps (kw, ke), _mm_add_ps (kn, ks));
+      __m128 w = _mm_and_ps (_mm_cmpgt_ps (weight_sum, epsilon),
+                             _mm_div_ps (strength, weight_sum));
+      gint j;
+
+      for (j = 0; j < 4; j++)
+        {
+          const gfloat *cj = center + j * plane;
+          __m128 v = _mm_loadu_ps (cj);
+          __m128 sum;
+
+          sum = _mm_mul_ps (kw, _mm_sub_ps (_mm_loadu_ps (cj - 1), v));
+          sum = _mm_add_ps (sum, _mm_mul_ps (ke, _mm_sub_ps (_mm_loadu_ps (cj + 1), v)));
+          sum = _mm_add_ps (sum, _mm_mul_ps (kn, _mm_sub_ps (_mm_loadu_ps (cj - width), v)));
+          sum = _mm_add_ps (sum, _mm_mul_ps (ks, _mm_sub_ps (_mm_loadu_ps (cj + width), v)));
+          sum = _mm_min_ps (_mm_max_ps (_mm_mul_ps (w, sum), lo), hi);
+
+          v = _mm_add_ps (v, _mm_mul_ps (delta_t, sum));
+          v = _mm_min_ps (_mm_max_ps (v, zero), one);
+          _mm_storeu_ps (dst + offset + j * plane, v);
+        }
+    }
+
+  return TRUE;
+}
+#endif /* ARCH_X86_64 */
+
+#if defined (__aarch64__) && defined (__ARM_NEON)
+#include <arm_neon.h>
+
+static inline float32x4_t
+fast_exp_neon (float32x4_t x)
+{
+  float32x4_t t = vmaxq_f32 (vmulq_n_f32 (x, 1.44269504f), vdupq_n_f32 (-126.0f));
+  float32x4_t i = vrndnq_f32 (t);
+  float32x4_t f = vsubq_f32 (t, i);
+  float32x4_t r = vdupq_n_f32 (EXP2_C6);
+  int32x4_t   e;
+
+  r = vfmaq_f32 (vdupq_n_f32 (EXP2_C5), r, f);
+  r = vfmaq_f32 (vdupq_n_f32 (EXP2_C4), r, f);
+  r = vfmaq_f32 (vdupq_n_f32 (EXP2_C3), r, f);
+  r = vfmaq_f32 (vdupq_n_f32 (EXP2_C2), r, f);
+  r = vfmaq_f32 (vdupq_n_f32 (EXP2_C1), r, f);
+  r = vfmaq_f32 (vdupq_n_f32 (EXP2_C0), r, f);
+
+  e = vshlq_n_s32 (vaddq_s32 (vcvtq_s32_f32 (i), vdupq_n_s32 (127)), 23);
+  return vmulq_f32 (r, vreinterpretq_f32_s32 (e));
+}
+
+static gboolean
+diffuse_row_neon (const gfloat        *src,
+                  gfloat              *dst,
+                  gsize                plane,
+                  gint                 width,
+                  gint                 y,
+                  const DiffuseParams *p)
+{
+  const gfloat      scale_x = -1.0f / (p->kappa * p->kappa);
+  const float32x4_t strength = vdupq_n_f32 (p->alpha_strength);
+  const float32x4_t delta_t = vdupq_n_f32 (p->delta_t);
+  const float32x4_t epsilon = vdupq_n_f32 (1e-6f);
+  const float32x4_t lo = vdupq_n_f32 (-2.0f);
+  const float32x4_t hi = vdupq_n_f32 (2.0f);
+  const float32x4_t zero = vdupq_n_f32 (0.0f);
+  const float32x4_t one = vdupq_n_f32 (1.0f);
+  const gsize       row = (gsize) y * width;
+  gint x;
+
+  if (width - 2 < 4)
+    return FALSE;
+
+  for (x = 1; x < width - 1; x += 4)
+    {
+      const gsize   offset = row + MIN (x, width - 5);
+      const gfloat *center = src + offset;
+      float32x4_t c  = vld1q_f32 (center);
+      float32x4_t gw = vsubq_f32 (vld1q_f32 (center - 1), c);
+      float32x4_t ge = vsubq_f32 (vld1q_f32 (center + 1), c);
+      float32x4_t gn = vsubq_f32 (vld1q_f32 (center - width), c);
+      float32x4_t gs = vsubq_f32 (vld1q_f32 (center + width), c);
+      float32x4_t kw = fast_exp_neon (vmulq_n_f32 (vmulq_f32 (gw, gw), scale_x));
+      float32x4_t ke = fast_exp_neon (vmulq_n_f32 (vmulq_f32 (ge, ge), scale_x));
+      float32x4_t kn = fast_exp_neon (vmulq_n_f32 (vmulq_f32 (gn, gn), scale_x));
+      float32x4_t ks = fast_exp_neon (vmulq_n_f32 (vmulq_f32 (gs, gs), scale_x));
+      float32x4_t weight_sum = vaddq_f32 (vaddq_f32 (kw, ke), vaddq_f32 (kn, ks));
+      uint32x4_t  valid = vcgtq_f32 (weight_sum, epsilon);
+      float32x4_t w = vreinterpretq_f32_u32 (
+                        vandq_u32 (valid, vreinterpretq_u32_f32 (
+                                            vdivq_f32 (strength, weight_sum))));
+      gint j;
+
+      for (j = 0; j < 4; j++)
+        {
+          const gfloat *cj = center + j * plane;
+          float32x4_t v = vld1q_f32 (cj);
+          float32x4_t sum;
+
+          sum = vmulq_f32 (kw, vsubq_f32 (vld1q_f32 (cj - 1), v));
+          sum = vfmaq_f32 (sum, ke, vsubq_f32 (vld1q_f32 (cj + 1), v));
+          sum = vfmaq_f32 (sum, kn, vsubq_f32 (vld1q_f32 (cj - width), v));
+          sum = vfmaq_f32 (sum, ks, vsubq_f32 (vld1q_f32 (cj + width), v));
+          sum = vminq_f32 (vmaxq_f32 (vmulq_f32 (w, sum), lo), hi);
+
+          v = vfmaq_f32 (v, delta_t, sum);
+          v = vminq_f32 (vmaxq_f32 (v, zero), one);
+          vst1q_f32 (dst + offset + j * plane, v);
+        }
+    }
+
+  return TRUE;
+}
+#endif /* __aarch64__ && __ARM_NEON */
+
+/* Picks the widest kernel the CPU running the plugin supports; without one
+ * every pixel goes through diffuse_pixel () with the exact expf ().
+ */
+static void
+diffuse_init (void)
+{
+#if defined (ARCH_X86_64)
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+    diffuse_row = diffuse_row_avx2;
+  else if (__builtin_cpu_supports ("sse4.1"))
+    diffuse_row = diffuse_row_sse4;
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+  diffuse_row = diffuse_row_neon;
+#endif
+}
+
+/* One explicit diffusion step over a planar width x height RGBA region */
+static void
+diffuse_step (const gfloat        *src,
+              gfloat              *dst,
+              gint                 width,
+              gint                 height,
+              const DiffuseParams *p)
+{
+  const gsize plane = (gsize) width * height;
+  gint x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      if (y > 0 && y < height - 1 &&
+          diffuse_row && diffuse_row (src, dst, plane, width, y, p))
+        {
+          diffuse_pixel (src, dst, plane, width, height, 0, y, p);
+          diffuse_pixel (src, dst, plane, width, height, width - 1, y, p);
+          continue;
+        }
+
+      for (x = 0; x < width; x++)
+        diffuse_pixel (src, dst, plane, width, height, x, y, p);
+    }
+}
+
+
+/* Runs n explicit steps on the planar region in *src with *dst as scratch;
+ * the result is left in *src.
+ */
+static void
+diffuse_iterate (gfloat              **src,
+                 gfloat              **dst,
+                 gint                  width,
+                 gint                  height,
+                 gint                  n,
+                 const DiffuseParams  *p)
+{
+  gint i;
+
+  for (i = 0; i < n; i++)
+    {
+      gfloat *tmp;
+
+      diffuse_step (*src, *dst, width, height, p);
+
+      tmp = *src;
+      *src = *dst;
+      *dst = tmp;
+    }
+}
+
+/* Additive operator splitting (Weickert): one step of length tau is
+ *
+ *   u' = 1/2 ((I - 2 tau A_x)^-1 + (I - 2 tau A_y)^-1) u
+ *
+ * where A_x and A_y hold the horizontal and vertical halves of the same
+ * operator the explicit step applies: the red channel conductance towards
+ * each neighbour, scaled by alpha x strength over the sum of all four.
+ * Each inverse is a diagonally dominant tridiagonal solve per row or
+ * column (Thomas algorithm), so any tau is stable and no clamp on the
+ * update is needed.  Rows are solved one at a time; columns are swept
+ * for a whole row of them at once to stay in cache order.  The result is
+ * left in *src, *dst is scratch like for diffuse_iterate ().
+ */
+static void
+diffuse_aos (gfloat              **src,
+             gfloat              **dst,
+             gint                  width,
+             gint                  height,
+             gint                  iterations,
+             const DiffuseParams  *p)
+{
+  const gsize plane = (gsize) width * height;
+  const gint  steps = aos_steps (iterations, p->delta_t);
+  const gfloat tau = iterations * p->delta_t / steps;
+  gfloat *g_east = g_new (gfloat, plane);  /* between x and x + 1 */
+  gfloat *g_south = g_new (gfloat, plane); /* between y and y + 1 */
+  gfloat *coef = g_new (gfloat, plane);
+  gfloat *cp = g_new (gfloat, plane);      /* forward sweep: scaled super-diagonal */
+  gfloat *dp = g_new (gfloat, plane * 4);  /* and right hand sides */
+  gint    step, x, y, j;
+
+  for (step = 0; step < steps; step++)
+    {
+      const gfloat *u = *src;
+      gfloat       *out = *dst;
+      gfloat       *tmp;
+      gsize         i;
+
+      for (y = 0; y < height; y++)
+        for (x = 0; x < width; x++)
+          {
+            i = (gsize) y * width + x;
+            g_east[i] = x < width - 1 ?
+                        conductance (fabsf (u[i + 1] - u[i]), p->kappa) : 0.0f;
+            g_south[i] = y < height - 1 ?
+                         conductance (fabsf (u[i + width] - u[i]), p->kappa) : 0.0f;
+          }
+
+      for (y = 0; y < height; y++)
+        for (x = 0; x < width; x++)
+          {
+            gfloat weight_sum;
+
+            i = (gsize) y * width + x;
+            weight_sum = g_east[i] + g_south[i] +
+                         (x > 0 ? g_east[i - 1] : 0.0f) +
+                         (y > 0 ? g_south[i - width] : 0.0f);
+            coef[i] = weight_sum > 1e-6f ?
+                      2.0f * tau * p->alpha_strength / weight_sum : 0.0f;
+          }
+
+      /* (I - 2 tau A_x) v = u, half of v goes to out */
+      for (y = 0; y < height; y++)
+        {
+          const gsize row = (gsize) y * width;
+
+          for (x = 0; x < width; x++)
+            {
+              gfloat lower, upper, m;
+
+              i = row + x;
+              lower = x > 0 ? -coef[i] * g_east[i - 1] : 0.0f;
+              upper = -coef[i] * g_east[i];
+              m = 1.0f - lower - upper;
+              if (x > 0)
+                m -= lower * cp[i - 1];
+              m = 1.0f / m;
+
+              cp[i] = upper * m;
+              for (j = 0; j < 4; j++)
+                dp[j * plane + i] = (u[j * plane + i] -
+                                     (x > 0 ? lower * dp[j * plane + i - 1] : 0.0f)) * m;
+            }
+
+          for (x = width - 1; x >= 0; x--)
+            {
+              i = row + x;
+              for (j = 0; j < 4; j++)
+                {
+                  if (x < width - 1)
+                    dp[j * plane + i] -= cp[i] * dp[j * plane + i + 1];
+                  out[j * plane + i] = 0.5f * dp[j * plane + i];
+                }
+            }
+        }
+
+      /* (I - 2 tau A_y) v = u, the other half */
+      for (y = 0; y < height; y++)
+        for (x = 0; x < width; x++)
+          {
+            gfloat lower, upper, m;
+
+            i = (gsize) y * width + x;
+            lower = y > 0 ? -coef[i] * g_south[i - width] : 0.0f;
+            upper = -coef[i] * g_south[i];
+            m = 1.0f - lower - upper;
+            if (y > 0)
+              m -= lower * cp[i - width];
+            m = 1.0f / m;
+
+            cp[i] = upper * m;
+            for (j = 0; j < 4; j++)
+              dp[j * plane + i] = (u[j * plane + i] -
+                                   (y > 0 ? lower * dp[j * plane + i - width] : 0.0f)) * m;
+          }
+
+      for (y = height - 1; y >= 0; y--)
+        for (x = 0; x < width; x++)
+          {
+            i = (gsize) y * width + x;
+            for (j = 0; j < 4; j++)
+              {
+                gfloat value;
+
+                if (y < height - 1)
+                  dp[j * plane + i] -= cp[i] * dp[j * plane + i + width];
+                value = out[j * plane + i] + 0.5f * dp[j * plane + i];
+                out[j * plane + i] = CLAMP (value, 0.0f, 1.0f);
+              }
+          }
+
+      tmp = *src;
+      *src = *dst;
+      *dst = tmp;
+    }
+
+  g_free (dp);
+  g_free (cp);
+  g_free (coef);
+  g_free (g_south);
+  g_free (g_east);
+}
+
+/* Diffuses for iterations x delta_t with the chosen solver */
+static void
+diffuse_run (gfloat              **src,
+             gfloat              **dst,
+             gint                  width,
+             gint                  height,
+             gint                  iterations,
+             gint                  solver,
+             const DiffuseParams  *p)
+{
+  if (solver == SMOOTH_SOLVER_AOS)
+    diffuse_aos (src, dst, width, height, iterations, p);
+  else
+    diffuse_iterate (src, dst, width, height, iterations, p);
+}
+
+/* 2x2 box filter of a planar region; an odd last row or column averages
+ * with itself.
+ */
+static void
+downsample (const gfloat *src,
+            gint          width,
+            gint          height,
+            gfloat       *dst)
+{
+  const gint  dw = (width + 1) / 2;
+  const gint  dh = (height + 1) / 2;
+  const gsize plane = (gsize) width * height;
+  const gsize dplane = (gsize) dw * dh;
+  gint x, y, j;
+
+  for (j = 0; j < 4; j++)
+    for (y = 0; y < dh; y++)
+      {
+        const gfloat *row0 = src + j * plane + (gsize) (2 * y) * width;
+        const gfloat *row1 = src + j * plane + (gsize) MIN (2 * y + 1, height - 1) * width;
+        gfloat       *out = dst + j * dplane + (gsize) y * dw;
+
+        for (x = 0; x < dw; x++)
+          {
+            gint x0 = 2 * x;
+            gint x1 = MIN (2 * x + 1, width - 1);
+
+            out[x] = 0.25f * (row0[x0] + row0[x1] + row1[x0] + row1[x1]);
+          }
+      }
+}
+
+/* Adds the change a coarse level went through (after - before) to the
+ * level above it.  The four bilinear taps are also weighted by how close
+ * the coarse value is to the fine pixel, with the same conductance the
+ * diffusion uses, so smoothing does not bleed across edges the coarse
+ * level could not resolve.
+ */
+static void
+upsample_delta (const gfloat *before,
+                const gfloat *after,
+                gint          cw,
+                gint          ch,
+                gfloat       *fine,
+                gint          fw,
+                gint          fh,
+                gfloat        kappa)
+{
+  const gsize cplane = (gsize) cw * ch;
+  const gsize fplane = (gsize) fw * fh;
+  gint x, y, j, k;
+
+  for (y = 0; y < fh; y++)
+    {
+      gfloat fy = (y + 0.5f) * 0.5f - 0.5f;
+      gint   y0 = (gint) floorf (fy);
+      gfloat ty = fy - y0;
+      gint   y1;
+
+      if (y0 < 0)
+        {
+          y0 = 0;
+          ty = 0.0f;
+        }
+      y1 = MIN (y0 + 1, ch - 1);
+
+      for (x = 0; x < fw; x++)
+        {
+          const gsize offset = (gsize) y * fw + x;
+          gfloat fx = (x + 0.5f) * 0.5f - 0.5f;
+          gint   x0 = (gint) floorf (fx);
+          gfloat tx = fx - x0;
+          gint   x1;
+          gsize  taps[4];
+          gfloat weights[4];
+          gfloat weight_sum = 0.0f;
+
+          if (x0 < 0)
+            {
+              x0 = 0;
+              tx = 0.0f;
+            }
+          x1 = MIN (x0 + 1, cw - 1);
+
+          taps[0] = (gsize) y0 * cw + x0;
+          taps[1] = (gsize) y0 * cw + x1;
+          taps[2] = (gsize) y1 * cw + x0;
+          taps[3] = (gsize) y1 * cw + x1;
+          weights[0] = (1.0f - tx) * (1.0f - ty);
+          weights[1] = tx * (1.0f - ty);
+          weights[2] = (1.0f - tx) * ty;
+          weights[3] = tx * ty;
+
+          for (k = 0; k < 4; k++)
+            {
+              weights[k] *= conductance (fabsf (fine[offset] - before[taps[k]]), kappa);
+              weight_sum += weights[k];
+            }
+
+          if (weight_sum <= 1e-6f)
+            continue;
+
+          for (j = 0; j < 4; j++)
+            {
+              gfloat delta = 0.0f;
+              gfloat value;
+
+              for (k = 0; k < 4; k++)
+                delta += weights[k] * (after[j * cplane + taps[k]] -
+                                       before[j * cplane + taps[k]]);
+
+              value = fine[j * fplane + offset] + delta / weight_sum;
+              fine[j * fplane + offset] = CLAMP (value, 0.0f, 1.0f);
+            }
+        }
+    }
+}
+
+static gfloat *
+region_dup (const gfloat *region,
+            gint          width,
+            gint          height)
+{
+  gsize   n = (gsize) width * height * 4;
+  gfloat *copy = g_new (gfloat, n);
+
+  memcpy (copy, region, n * sizeof (gfloat));
+  return copy;
+}
+
+#define MAX_PYRAMID_LEVELS 4
+
+/* Pyramid mode: the region in *src is box filtered down levels times,
+ * the coarsest level is diffused (for 4^levels fewer iterations), and
+ * the change is brought back up one level at a time, each followed by a
+ * single explicit step to repair what the upsampling smeared.  The result
+ * is left in *src, *dst is scratch like for diffuse_iterate ().
+ */
+static void
+diffuse_pyramid (gfloat              **src,
+                 gfloat              **dst,
+                 gint                  width,
+                 gint                  height,
+                 gint                  levels,
+                 gint                  iterations,
+                 gint                  solver,
+                 const DiffuseParams  *p)
+{
+  gfloat *orig[MAX_PYRAMID_LEVELS + 1];
+  gint    w[MAX_PYRAMID_LEVELS + 1];
+  gint    h[MAX_PYRAMID_LEVELS + 1];
+  gfloat *cur;
+  gfloat *scratch;
+  gint    k;
+
+  levels = MIN (levels, MAX_PYRAMID_LEVELS);
+
+  orig[0] = *src;
+  w[0] = width;
+  h[0] = height;
+  for (k = 1; k <= levels; k++)
+    {
+      w[k] = (w[k - 1] + 1) / 2;
+      h[k] = (h[k - 1] + 1) / 2;
+      orig[k] = g_new (gfloat, (gsize) w[k] * h[k] * 4);
+      downsample (orig[k - 1], w[k - 1], h[k - 1], orig[k]);
+    }
+
+  cur = region_dup (orig[levels], w[levels], h[levels]);
+  scratch = g_new (gfloat, (gsize) w[levels] * h[levels] * 4);
+  diffuse_run (&cur, &scratch, w[levels], h[levels],
+               pyramid_iterations (iterations, levels), solver, p);
+
+  for (k = levels; k > 0; k--)
+    {
+      gfloat *fine;
+
+      /* Level 0 is updated in place, the others are still needed as the
+       * reference for the level above them.
+       */
+      if (k - 1 == 0)
+        fine = orig[0];
+      else
+        fine = region_dup (orig[k - 1], w[k - 1], h[k - 1]);
+
+      upsample_delta (orig[k], cur, w[k], h[k], fine, w[k - 1], h[k - 1], p->kappa);
+
+      g_free (cur);
+      g_free (scratch);
+      g_free (orig[k]);
+
+      if (k - 1 == 0)
+        {
+          diffuse_iterate (src, dst, width, height, 1, p);
+        }
+      else
+        {
+          cur = fine;
+          scratch = g_new (gfloat, (gsize) w[k - 1] * h[k - 1] * 4);
+          diffuse_iterate (&cur, &scratch, w[k - 1], h[k - 1], 1, p);
+        }
+    }
+}
+
+/* The level's pixel grid covers rect at 1 / 2^level scale */
+static GeglRectangle
+rect_at_level (const GeglRectangle *rect,
+               gint                 level)
+{
+  GeglRectangle scaled;
+  gint          size = 1 << level;
+
+  scaled.x = (gint) floor ((gdouble) rect->x / size);
+  scaled.y = (gint) floor ((gdouble) rect->y / size);
+  scaled.width = (gint) ceil ((gdouble) (rect->x + rect->width) / size) - scaled.x;
+  scaled.height = (gint) ceil ((gdouble) (rect->y + rect->height) / size) - scaled.y;
+  return scaled;
+}
+
+/* Called for every row of a finished band while it is still in cache;
+ * pixels holds row y of band, interleaved, and may be changed in place
+ * before it is written.
+ */
+typedef void (* DiffuseOutputFunc) (const GeglRectangle *band,
+                                    gint                 y,
+                                    gfloat              *pixels,
+                                    gpointer             data);
+
+/* The region to diffuse for output rect: rect plus its halo, clipped to
+ * bounds, the image at this level; the image border is the only place
+ * where neighbours are missing, so the part inside rect matches the
+ * full-frame output exactly.
+ */
+static GeglRectangle
+diffuse_work_rect (GeglProperties      *o,
+                   const GeglRectangle *rect,
+                   const GeglRectangle *bounds,
+                   gint                 level)
+{
+  GeglRectangle work;
+  gint          halo;
+
+  if (o->full_frame || !bounds)
+    return bounds ? *bounds : *rect;
+
+  halo = get_halo (o, level);
+  work = *rect;
+  work.x -= halo;
+  work.y -= halo;
+  work.width += 2 * halo;
+  work.height += 2 * halo;
+
+  /* Pyramid cells are aligned to the image origin so that every tile
+   * box filters the same pixels together.
+   */
+  if (o->pyramid_levels > 0)
+    {
+      gint cell = 1 << MIN (o->pyramid_levels, MAX_PYRAMID_LEVELS);
+      gint shift = (work.x - bounds->x) & (cell - 1);
+
+      work.x -= shift;
+      work.width += shift;
+      shift = (work.y - bounds->y) & (cell - 1);
+      work.y -= shift;
+      work.height += shift;
+    }
+
+  gegl_rectangle_intersect (&work, &work, bounds);
+  return work;
+}
+
+/* Input rows kept between the bands of a strip mode call.  Bands move
+ * down the image and consecutive ones overlap by their context rows, so
+ * only the rows below the last band's region are read.
+ */
+typedef struct
+{
+  gfloat *rows;
+  gint    width;
+  gint    n_rows;
+  gint    y;       /* rows y .. y_end - 1 are held */
+  gint    y_end;
+} DiffuseRing;
+
+static inline gfloat *
+diffuse_ring_row (DiffuseRing *ring,
+                  gint         y)
+{
+  gint slot = y % ring->n_rows;
+
+  if (slot < 0)
+    slot += ring->n_rows;
+  return ring->rows + (gsize) slot * ring->width * 4;
+}
+
+static void
+diffuse_ring_fetch (DiffuseRing         *ring,
+                    GeglBuffer          *input,
+                    const GeglRectangle *work,
+                    gint                 level,
+                    const Babl          *format)
+{
+  gint y = work->y;
+  gint y_end = work->y + work->height;
+
+  if (ring->y < ring->y_end && work->y >= ring->y && work->y <= ring->y_end)
+    y = ring->y_end;
+
+  /* One read per run of consecutive slots */
+  while (y < y_end)
+    {
+      gfloat       *row = diffuse_ring_row (ring, y);
+      gint          slot = (row - ring->rows) / ((gsize) ring->width * 4);
+      gint          n = MIN (y_end - y, ring->n_rows - slot);
+      GeglRectangle rows = {work->x, y, work->width, n};
+
+      gegl_buffer_get (input, &rows, 1.0 / (1 << level), format, row,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
+      y += n;
+    }
+
+  ring->y = work->y;
+  ring->y_end = MAX (y, y_end);
+}
+
+/* Diffuses work and writes its part band to output.  src and dst hold at
+ * least four planes of work; without a ring the input is read into dst,
+ * which doubles as the interleaved staging area on the way in and out.
+ */
+static void
+diffuse_band (GeglProperties       *o,
+              GeglBuffer           *input,
+              GeglBuffer           *output,
+              const GeglRectangle  *band,
+              const GeglRectangle  *work,
+              gint                  level,
+              gint                  iterations,
+              const Babl           *format,
+              const DiffuseParams  *params,
+              DiffuseRing          *ring,
+              gfloat              **src,
+              gfloat              **dst,
+              DiffuseOutputFunc     output_func,
+              gpointer              output_data,
+              GrokTraceSpan        *span)
+{
+  gsize plane = (gsize) work->width * work->height;
+  gsize n;
+  gint i, j;
+
+  if (ring)
+    {
+      diffuse_ring_fetch (ring, input, work, level, format);
+      for (i = 0; i < work->height; i++)
+        {
+          const gfloat *row = diffuse_ring_row (ring, work->y + i);
+          gsize         offset = (gsize) i * work->width;
+
+          for (n = 0; n < (gsize) work->width; n++)
+            for (j = 0; j < 4; j++)
+              (*src)[j * plane + offset + n] = row[n * 4 + j];
+        }
+    }
+  else
+    {
+      gegl_buffer_get (input, work, 1.0 / (1 << level), format, *dst,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
+
+      for (n = 0; n < plane; n++)
+        for (j = 0; j < 4; j++)
+          (*src)[j * plane + n] = (*dst)[n * 4 + j];
+    }
+
+  if (o->pyramid_levels > 0)
+    diffuse_pyramid (src, dst, work->width, work->height,
+                     o->pyramid_levels, iterations, o->solver, params);
+  else
+    diffuse_run (src, dst, work->width, work->height,
+                 iterations, o->solver, params);
+
+  /* Steps actually taken: the coarsest pyramid level runs the reduced
+   * count and every finer one adds a repair step.  AOS allocates eight
+   * more planes of its region.
+   */
+  if (G_UNLIKELY (span->op))
+    {
+      gint levels = MIN (o->pyramid_levels, MAX_PYRAMID_LEVELS);
+      gint steps = levels > 0 ? pyramid_iterations (iterations, levels) : iterations;
+
+      if (o->solver == SMOOTH_SOLVER_AOS)
+        {
+          steps = aos_steps (steps, o->delta_t);
+          grok_trace_scratch (span, (plane >> (2 * levels)) * 8 * sizeof (gfloat));
+        }
+      grok_trace_iterations (span, steps + levels);
+    }
+
+  /* Only the band's own part of the diffused region is written */
+  for (i = 0; i < band->height; i++)
+    {
+      gsize  row = (gsize) (band->y - work->y + i) * work->width +
+                   (band->x - work->x);
+      gfloat *out = *dst + (gsize) i * band->width * 4;
+
+      for (n = 0; n < (gsize) band->width; n++)
+        for (j = 0; j < 4; j++)
+          out[n * 4 + j] = (*src)[j * plane + row + n];
+
+      if (output_func)
+        output_func (band, band->y + i, out, output_data);
+    }
+
+  gegl_buffer_set (output, band, level, format, *dst, GEGL_AUTO_ROWSTRIDE);
+}
+
+/* Diffuses the part of input that result needs, at mipmap level, and
+ * writes what of result lies inside the image to output, setting out_rect
+ * to it.  Returns FALSE when result is outside the image.
+ *
+ * With strip_rows set, result is done in horizontal bands of that many
+ * rows, top to bottom, each written as soon as it is finished.  Only one
+ * band's region and a ring of its input rows are resident, instead of
+ * all of result plus its halo, so a large request stays within a fixed
+ * amount of memory; with GEGL's swap enabled, or a file-backed output
+ * buffer, images larger than RAM go through in one render.  Every band
+ * is diffused like a tile with its own halo, so the output is the same.
+ */
+static gboolean
+diffuse_region (GeglProperties      *o,
+                GeglBuffer          *input,
+                GeglBuffer          *output,
+                const GeglRectangle *in_rect,
+                const GeglRectangle *result,
+                gint                 level,
+                const Babl          *format,
+                DiffuseOutputFunc    output_func,
+                gpointer             output_data,
+                GeglRectangle       *out_rect,
+                GrokTraceSpan       *span)
+{
+  GeglRectangle  bounds;
+  GeglRectangle  work;
+  DiffuseParams  params;
+  DiffuseRing    ring = {NULL, 0, 0, 0, 0};
+  gfloat        *src;
+  gfloat        *dst;
+  gsize          capacity;
+  gint           iterations;
+  gint           strip;
+  gint           i;
+
+  /* Too small to diffuse, the pixels pass through */
+  if (level == 0 && (result->width < 2 || result->height < 2))
+    {
+      *out_rect = *result;
+      dst = g_new (gfloat, (gsize) result->width * result->height * 4);
+      gegl_buffer_get (input, result, 1.0, format, dst,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
+
+      if (output_func)
+        for (i = 0; i < result->height; i++)
+          output_func (result, result->y + i,
+                       dst + (gsize) i * result->width * 4, output_data);
+
+      gegl_buffer_set (output, result, level, format, dst, GEGL_AUTO_ROWSTRIDE);
+      g_free (dst);
+      return TRUE;
+    }
+
+  /* result is in the coordinates of the mipmap level being rendered;
+   * previews at a zoomed out level diffuse the smaller image with
+   * proportionally fewer steps.
+   */
+  iterations = iterations_at_level (o->iterations, level);
+  if (in_rect)
+    bounds = rect_at_level (in_rect, level);
+
+  work = diffuse_work_rect (o, result, in_rect ? &bounds : NULL, level);
+  if (!gegl_rectangle_intersect (out_rect, result, &work))
+    return FALSE;
+
+  params.kappa = o->kappa;
+  params.alpha_strength = o->alpha * o->strength;
+  params.delta_t = o->delta_t;
+
+  /* Full-frame is the one piece reference, it is never split */
+  strip = o->full_frame || !in_rect ? 0 : o->strip_rows;
+
+  if (strip <= 0 || strip >= out_rect->height)
+    {
+      /* Two planar scratch arrays for the whole call, swapped between
+       * iterations, so output is only touched once, after the last one.
+       */
+      capacity = (gsize) work.width * work.height * 4;
+      src = g_new (gfloat, capacity);
+      dst = g_new (gfloat, capacity);
+      grok_trace_scratch (span, capacity * 2 * sizeof (gfloat));
+
+      diffuse_band (o, input, output, out_rect, &work, level, iterations,
+                    format, &params, NULL, &src, &dst,
+                    output_func, output_data, span);
+    }
+  else
+    {
+      GeglRectangle band = *out_rect;
+      gint          cell = 1 << MIN (o->pyramid_levels, MAX_PYRAMID_LEVELS);
+
+      /* A band's region is at most its rows, the halo on both sides and
+       * the shift onto the pyramid grid, which also bounds the ring.
+       */
+      ring.width = work.width;
+      ring.n_rows = MIN (strip + 2 * get_halo (o, level) + cell, work.height);
+      ring.rows = g_new (gfloat, (gsize) ring.width * ring.n_rows * 4);
+
+      capacity = (gsize) ring.width * ring.n_rows * 4;
+      src = g_new (gfloat, capacity);
+      dst = g_new (gfloat, capacity);
+      grok_trace_scratch (span, capacity * 3 * sizeof (gfloat));
+
+      for (band.y = out_rect->y; band.y < out_rect->y + out_rect->height; band.y += strip)
+        {
+          GeglRectangle band_work;
+
+          band.height = MIN (strip, out_rect->y + out_rect->height - band.y);
+          band_work = diffuse_work_rect (o, &band, &bounds, level);
+
+          diffuse_band (o, input, output, &band, &band_work, level, iterations,
+                        format, &params, &ring, &src, &dst,
+                        output_func, output_data, span);
+        }
+
+      g_free (ring.rows);
+    }
+
+  g_free (dst);
+  g_free (src);
+  return TRUE;
+}
+
+#endif /* __GROK_DIFFUSE_H__ */
@@ -0,0 +1,212 @@
+/* grok-flowers.h
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The solid Hawaiian flower pattern, shared by hawaiian.c and
+ * hawaiin_flowers/hawaiian.c.
+ *
+ * Flowers sit on a staggered grid, every row shifted by half a period,
+ * and alternate between large and small.  A row of pixels is rendered by
+ * skipping rows that miss every flower, setting up each flower's cell once
+ * as the row enters it, and shading only the pixels inside its petal
+ * radius.  Include after gegl-op.h; it reads the flower_size,
+ * flower_spacing, size_ratio, rotation_variation, petal_scale, petal_color
+ * and center_color properties.
+ */
+
+#ifndef __GROK_FLOWERS_H__
+#define __GROK_FLOWERS_H__
+
+#include <math.h>
+#include <string.h>
+#include "grok-noise.h"
+
+/* The petal taper 1 - t^(2 + 2 * shape) sampled over t in [0, 1] */
+#define PETAL_PROFILE_SIZE 256
+
+/* Parameters of one flower, constant over its staggered-grid cell */
+typedef struct
+{
+  gfloat col;
+  gfloat cx;
+  gfloat petal_radius;
+  gfloat center_radius;
+  gfloat rotation;
+} FlowerCell;
+
+/* What stays fixed over one render */
+typedef struct
+{
+  GeglProperties *o;
+  gfloat          period;
+  gfloat          base_radius;
+  gfloat          petal_color[4];
+  gfloat          center_color[4];
+  gfloat          profile[PETAL_PROFILE_SIZE + 1];
+} FlowerPattern;
+
+static void
+init_petal_profile (gfloat  petal_scale,
+                    gfloat *profile)
+{
+  gfloat shape_factor = (petal_scale - 0.5f) / 1.5f;
+  gint   i;
+
+  for (i = 0; i <= PETAL_PROFILE_SIZE; i++)
+    profile[i] = 1.0f - powf ((gfloat) i / PETAL_PROFILE_SIZE,
+                              2.0f + shape_factor * 2.0f);
+}
+
+static inline gfloat
+petal_profile (const gfloat *profile,
+               gfloat        t)
+{
+  gfloat pos = t * PETAL_PROFILE_SIZE;
+  gint   i   = MIN ((gint) pos, PETAL_PROFILE_SIZE - 1);
+
+  return profile[i] + (profile[i + 1] - profile[i]) * (pos - i);
+}
+
+static void
+init_flower_pattern (GeglProperties *o,
+                     const Babl     *format,
+                     FlowerPattern  *pattern)
+{
+  pattern->o = o;
+  pattern->period = o->flower_size + o->flower_spacing;
+  pattern->base_radius = o->flower_size * 0.5f;
+  gegl_color_get_pixel (o->petal_color, format, pattern->petal_color);
+  gegl_color_get_pixel (o->center_color, format, pattern->center_color);
+  init_petal_profile (o->petal_scale, pattern->profile);
+}
+
+static void
+init_flower_cell (GeglProperties *o,
+                  gfloat          period,
+                  gfloat          row,
+                  gfloat          row_offset,
+                  gfloat          col,
+                  FlowerCell     *cell)
+{
+  /* Alternate between large and small flowers */
+  gfloat seed = grok_noise2 ((gint) col, (gint) row, 0);
+  gfloat size_factor = (fmodf (row + col, 2.0f) < 1.0f) ? 1.0f : o->size_ratio;
+
+  cell->col = col;
+  cell->cx = col * period + period * 0.5f + row_offset;
+  cell->petal_radius = o->flower_size * 0.5f * size_factor;
+  cell->center_radius = o->flower_size * 0.1f * size_factor;
+
+  /* Per-flower rotation */
+  cell->rotation = o->rotation_variation * (seed - 0.5f) * G_PI / 180.0f;
+}
+
+/* Shades one premultiplied pixel at (dx, dy) from the flower centre; the
+ * caller has already rejected pixels outside the petal radius.
+ */
+static void
+shade_flower (const FlowerCell *cell,
+              const gfloat     *profile,
+              const gfloat     *petal_color,
+              const gfloat     *center_color,
+              gfloat            dx,
+              gfloat            dy,
+              gfloat           *out)
+{
+  gfloat dist = sqrtf (dx * dx + dy * dy);
+  gfloat alpha = 0.0f;
+  const gfloat *color = center_color;
+  gint j;
+
+  if (dist <= cell->center_radius)
+    {
+      /* Flower center with a linear falloff toward its edge */
+      gfloat center_factor = dist / cell->center_radius;
+
+      alpha = CLAMP (1.0f - center_factor * 0.5f, 0.0f, 1.0f);
+    }
+  else
+    {
+      /* Five petals, tapered by the petal_scale profile */
+      gfloat angle = atan2f (dy, dx) + cell->rotation;
+      gfloat petal_angle = fmodf (angle, 2.0f * G_PI / 5.0f) - 2.0f * G_PI / 10.0f;
+
+      if (fabsf (petal_angle) < G_PI / 5.0f)
+        {
+          gfloat t = dist / cell->petal_radius;
+          gfloat w = cell->petal_radius * 0.5f * petal_profile (profile, t);
+          gfloat angular_distance = fabsf (petal_angle) / (G_PI / 5.0f);
+          gfloat edge_factor = angular_distance * cell->petal_radius / w;
+
+          alpha = CLAMP (1.0f - edge_factor * 0.5f, 0.0f, 1.0f);
+          color = petal_color;
+        }
+    }
+
+  for (j = 0; j < 3; j++)
+    out[j] = color[j] * alpha;
+  out[3] = alpha;
+}
+
+/* Premultiplied RGBA for n pixels of row y starting at column x */
+static void
+render_flower_row (const FlowerPattern *pattern,
+                   gint                 x,
+                   gint                 y,
+                   gint                 n,
+                   gfloat              *out)
+{
+  gfloat     period = pattern->period;
+  gfloat     py = y;
+
+  /* Staggered grid: every row of flowers shifts by half a period */
+  gfloat     row = floorf (py / period);
+  gfloat     row_offset = row * 0.5f * period;
+  gfloat     cy = row * period + period * 0.5f;
+  gfloat     dy = py - cy;
+  FlowerCell cell;
+  gint       i;
+
+  /* Rows that miss even the large flowers stay transparent */
+  if (fabsf (dy) >= pattern->base_radius)
+    {
+      memset (out, 0, sizeof (gfloat) * 4 * n);
+      return;
+    }
+
+  cell.col = G_MAXFLOAT;
+
+  for (i = 0; i < n; i++)
+    {
+      gfloat px = x + i;
+      gfloat col = floorf ((px - row_offset) / period);
+      gfloat dx;
+
+      if (col != cell.col)
+        init_flower_cell (pattern->o, period, row, row_offset, col, &cell);
+
+      dx = px - cell.cx;
+
+      if (dx * dx + dy * dy >= cell.petal_radius * cell.petal_radius)
+        memset (out + i * 4, 0, sizeof (gfloat) * 4);
+      else
+        shade_flower (&cell, pattern->profile, pattern->petal_color,
+                      pattern->center_color, dx, dy, out + i * 4);
+    }
+}
+
+#endif /* __GROK_FLOWERS_H__ */
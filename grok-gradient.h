@@ -0,0 +1,818 @@
+/* grok-gradient.h
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Gradient mapping shared by ai/lb:gradient and the ops that end in it.
+ *
+ * The including op declares GROK_GRADIENT_PROPERTIES from
+ * grok-properties.h, which also names the GROK2_GRADIENT_* and
+ * GROK2_SHAPE_* values used here, and includes this after gegl-op.h.
+ * It keeps a GradientCache in user_data: gradient_cache_update from
+ * prepare, gradient_map_row for every row of a chunk once its indices are
+ * known, and gradient_cache_free from finalize.
+ */
+
+#ifndef __GROK_GRADIENT_H__
+#define __GROK_GRADIENT_H__
+
+#include <glib/gstdio.h>
+#include <math.h>
+#include <string.h>
+#include "grok-kernel.h"
+#include "grok-row-cache.h"
+// HSV to RGB conversion
+static void
+hsv_to_rgb (gfloat h, gfloat s, gfloat v, gfloat *r, gfloat *g, gfloat *b)
+{
+  h = fmodf(h, 360.0);
+  if (h < 0.0)
+    h += 360.0;
+  s = CLAMP(s, 0.0, 1.0);
+  v = CLAMP(v, 0.0, 1.0);
+
+  gfloat c = v * s;
+  gfloat x = c * (1.0 - fabsf(fmodf(h / 60.0, 2.0) - 1.0));
+  gfloat m = v - c;
+
+  gfloat r1, g1, b1;
+  if (h < 60.0)
+    { r1 = c; g1 = x; b1 = 0.0; }
+  else if (h < 120.0)
+    { r1 = x; g1 = c; b1 = 0.0; }
+  else if (h < 180.0)
+    { r1 = 0.0; g1 = c; b1 = x; }
+  else if (h < 240.0)
+    { r1 = 0.0; g1 = x; b1 = c; }
+  else if (h < 300.0)
+    { r1 = x; g1 = 0.0; b1 = c; }
+  else
+    { r1 = c; g1 = 0.0; b1 = x; }
+
+  *r = r1 + m;
+  *g = g1 + m;
+  *b = b1 + m;
+}
+
+// RGB to HSV conversion
+static void
+rgb_to_hsv (gfloat r, gfloat g, gfloat b, gfloat *h, gfloat *s, gfloat *v)
+{
+  r = CLAMP(r, 0.0, 1.0);
+  g = CLAMP(g, 0.0, 1.0);
+  b = CLAMP(b, 0.0, 1.0);
+
+  gfloat max = fmaxf(fmaxf(r, g), b);
+  gfloat min = fminf(fminf(r, g), b);
+  gfloat delta = max - min;
+
+  *v = max;
+
+  if (max == 0.0 || delta == 0.0) {
+    *s = 0.0;
+    *h = 0.0;
+  } else {
+    *s = delta / max;
+    if (r == max)
+      *h = 60.0 * (g - b) / delta;
+    else if (g == max)
+      *h = 60.0 * (2.0 + (b - r) / delta);
+    else
+      *h = 60.0 * (4.0 + (r - g) / delta);
+    if (*h < 0.0)
+      *h += 360.0;
+  }
+}
+
+// Generic gradient interpolation function
+static void
+interpolate_gradient(gfloat t, const gfloat colors[][3], const gfloat stops[], gint n_segments, gfloat *r, gfloat *g, gfloat *b)
+{
+  for (gint i = 0; i < n_segments; i++) {
+    gfloat start = stops[i];
+    gfloat end = stops[i + 1];
+    if (t <= end) {
+      gfloat t_scaled = (t - start) / (end - start);
+      *r = colors[i][0] + t_scaled * (colors[i + 1][0] - colors[i][0]);
+      *g = colors[i][1] + t_scaled * (colors[i + 1][1] - colors[i][1]);
+      *b = colors[i][2] + t_scaled * (colors[i + 1][2] - colors[i][2]);
+      return;
+    }
+  }
+  // Fallback to last segment
+  *r = colors[n_segments][0];
+  *g = colors[n_segments][1];
+  *b = colors[n_segments][2];
+}
+
+// Built-in palettes: four colours on shared stops, indexed by gradient type.
+// Rainbow has no entry, it is a plain hue sweep.
+#define PALETTE_STOPS 4
+
+static const gfloat palette_stops[PALETTE_STOPS] = {0.0, 0.333, 0.667, 1.0};
+
+static const gfloat palette_colors[][PALETTE_STOPS][3] = {
+  [GROK2_GRADIENT_TROPICAL]          = {{0.0, 0.75, 0.75}, {0.5, 1.0, 0.0}, {1.0, 0.5, 0.5}, {0.0, 0.75, 0.75}},
+  [GROK2_GRADIENT_BERRY_BLAST]       = {{0.5, 0.0, 0.5}, {1.0, 0.5, 0.75}, {0.0, 0.5, 1.0}, {0.5, 0.0, 0.5}},
+  [GROK2_GRADIENT_CITRUS_ZEST]       = {{1.0, 1.0, 0.0}, {1.0, 0.5, 0.0}, {0.0, 1.0, 0.0}, {1.0, 1.0, 0.0}},
+  [GROK2_GRADIENT_MANGO_TANGO]       = {{1.0, 0.5, 0.0}, {1.0, 0.0, 0.0}, {1.0, 1.0, 0.0}, {1.0, 0.5, 0.0}},
+  [GROK2_GRADIENT_MELON_MEDLEY]      = {{0.0, 1.0, 0.0}, {1.0, 0.5, 0.75}, {1.0, 1.0, 0.0}, {0.0, 1.0, 0.0}},
+  [GROK2_GRADIENT_PEACH_DREAM]       = {{1.0, 0.75, 0.5}, {1.0, 0.5, 0.75}, {1.0, 0.5, 0.0}, {1.0, 0.75, 0.5}},
+  [GROK2_GRADIENT_PINEAPPLE_PUNCH]   = {{1.0, 1.0, 0.0}, {0.0, 1.0, 0.0}, {1.0, 0.5, 0.0}, {1.0, 1.0, 0.0}},
+  [GROK2_GRADIENT_TROPICAL_BREEZE]   = {{0.0, 1.0, 1.0}, {0.5, 0.0, 0.5}, {1.0, 1.0, 0.0}, {0.0, 1.0, 1.0}},
+  [GROK2_GRADIENT_GOLDEN]            = {{1.0, 0.84, 0.0}, {1.0, 0.5, 0.0}, {1.0, 1.0, 0.0}, {1.0, 0.84, 0.0}},
+  [GROK2_GRADIENT_SUNRISE]           = {{1.0, 0.0, 0.0}, {1.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}},
+  [GROK2_GRADIENT_ABSTRACT_1]        = {{0.0, 1.0, 1.0}, {1.0, 0.0, 1.0}, {1.0, 1.0, 0.0}, {0.0, 1.0, 1.0}},
+  [GROK2_GRADIENT_ABSTRACT_2]        = {{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}},
+  [GROK2_GRADIENT_ABSTRACT_3]        = {{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}},
+  [GROK2_GRADIENT_BLUUE_SUNSET]      = {{0.0, 0.0, 1.0}, {1.0, 0.5, 0.0}, {0.5, 0.0, 0.5}, {0.0, 0.0, 1.0}},
+  [GROK2_GRADIENT_FIRE_GLOW]         = {{1.0, 0.0, 0.0}, {1.0, 1.0, 0.0}, {1.0, 0.5, 0.0}, {1.0, 0.0, 0.0}},
+  [GROK2_GRADIENT_OCEAN_WAVE]        = {{0.0, 1.0, 1.0}, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 1.0, 1.0}},
+  [GROK2_GRADIENT_FOREST_GLADE]      = {{0.0, 1.0, 0.0}, {0.5, 0.25, 0.0}, {1.0, 1.0, 0.0}, {0.0, 1.0, 0.0}},
+  [GROK2_GRADIENT_PASTEL_DREAM]      = {{1.0, 0.75, 0.75}, {0.75, 0.75, 1.0}, {1.0, 1.0, 0.75}, {1.0, 0.75, 0.75}},
+  [GROK2_GRADIENT_NEON_GLOW]         = {{0.0, 1.0, 1.0}, {1.0, 0.0, 1.0}, {0.0, 0.0, 1.0}, {0.0, 1.0, 1.0}},
+  [GROK2_GRADIENT_AUTUMN_LEAVES]     = {{1.0, 0.0, 0.0}, {1.0, 0.5, 0.0}, {1.0, 1.0, 0.0}, {1.0, 0.0, 0.0}},
+  [GROK2_GRADIENT_PURPLE_HAZE]       = {{0.5, 0.0, 0.5}, {0.0, 0.0, 1.0}, {1.0, 0.5, 0.75}, {0.5, 0.0, 0.5}},
+  [GROK2_GRADIENT_DESERT_SAND]       = {{1.0, 1.0, 0.0}, {1.0, 0.5, 0.0}, {1.0, 0.75, 0.5}, {1.0, 1.0, 0.0}},
+  [GROK2_GRADIENT_ICY_FROST]         = {{0.0, 0.0, 1.0}, {0.0, 1.0, 1.0}, {1.0, 1.0, 1.0}, {0.0, 0.0, 1.0}},
+  [GROK2_GRADIENT_CANDY_SWIRL]       = {{1.0, 0.5, 0.75}, {0.0, 0.0, 1.0}, {1.0, 1.0, 0.0}, {1.0, 0.5, 0.75}},
+  [GROK2_GRADIENT_VIOLET_DUSK]       = {{0.5, 0.0, 0.5}, {0.0, 0.0, 1.0}, {1.0, 0.5, 0.0}, {0.5, 0.0, 0.5}},
+  [GROK2_GRADIENT_GREEN_LIME]        = {{0.0, 1.0, 0.0}, {1.0, 1.0, 0.0}, {0.5, 1.0, 0.0}, {0.0, 1.0, 0.0}},
+  [GROK2_GRADIENT_RED_SUNSET]        = {{1.0, 0.0, 0.0}, {1.0, 0.5, 0.0}, {0.5, 0.0, 0.5}, {1.0, 0.0, 0.0}},
+  [GROK2_GRADIENT_BLUE_LAGOON]       = {{0.0, 0.0, 1.0}, {0.0, 1.0, 1.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}},
+  [GROK2_GRADIENT_PINK_SUNRISE]      = {{1.0, 0.5, 0.75}, {1.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 0.5, 0.75}},
+  [GROK2_GRADIENT_COOL_BREEZE]       = {{0.0, 1.0, 1.0}, {0.0, 0.0, 1.0}, {0.5, 0.0, 0.5}, {0.0, 1.0, 1.0}},
+  [GROK2_GRADIENT_WARM_GLOW]         = {{1.0, 0.5, 0.0}, {1.0, 1.0, 0.0}, {1.0, 0.0, 0.0}, {1.0, 0.5, 0.0}},
+  [GROK2_GRADIENT_LAVENDER_MIST]     = {{0.75, 0.5, 1.0}, {1.0, 0.75, 0.75}, {0.5, 0.5, 1.0}, {0.75, 0.5, 1.0}},
+  [GROK2_GRADIENT_SKY_BLUE]          = {{0.0, 0.0, 1.0}, {0.0, 1.0, 1.0}, {1.0, 1.0, 1.0}, {0.0, 0.0, 1.0}},
+  [GROK2_GRADIENT_RAINBOW_CYCLE]     = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}},
+  [GROK2_GRADIENT_SUNSET_GLOW]       = {{1.0, 0.5, 0.0}, {1.0, 0.0, 0.0}, {1.0, 1.0, 0.0}, {1.0, 0.5, 0.0}},
+  [GROK2_GRADIENT_MINT_FRESH]        = {{0.0, 1.0, 0.0}, {0.0, 1.0, 1.0}, {0.0, 0.0, 1.0}, {0.0, 1.0, 0.0}},
+  [GROK2_GRADIENT_CORAL_REEF]        = {{1.0, 0.5, 0.5}, {0.0, 1.0, 1.0}, {0.0, 0.0, 1.0}, {1.0, 0.5, 0.5}},
+  [GROK2_GRADIENT_ELECTRIC_PULSE]    = {{0.0, 0.0, 1.0}, {0.5, 0.0, 0.5}, {0.0, 1.0, 1.0}, {0.0, 0.0, 1.0}},
+  [GROK2_GRADIENT_GOLD_SHIMMER]      = {{1.0, 0.84, 0.0}, {1.0, 0.75, 0.5}, {1.0, 1.0, 0.0}, {1.0, 0.84, 0.0}},
+  [GROK2_GRADIENT_GOLD_RADIANCE]     = {{1.0, 0.9, 0.2}, {1.0, 0.6, 0.0}, {1.0, 0.8, 0.4}, {1.0, 0.9, 0.2}},
+  [GROK2_GRADIENT_SILVER_GLEAM]      = {{0.8, 0.8, 0.9}, {1.0, 1.0, 1.0}, {0.6, 0.6, 0.7}, {0.8, 0.8, 0.9}},
+  [GROK2_GRADIENT_SILVER_LUSTER]     = {{0.9, 0.9, 1.0}, {0.7, 0.7, 0.8}, {1.0, 1.0, 1.0}, {0.9, 0.9, 1.0}},
+  [GROK2_GRADIENT_BRONZE_GLOW]       = {{0.8, 0.5, 0.2}, {1.0, 0.7, 0.4}, {0.6, 0.4, 0.2}, {0.8, 0.5, 0.2}},
+  [GROK2_GRADIENT_BRONZE_SHEEN]      = {{0.9, 0.6, 0.3}, {0.7, 0.4, 0.2}, {1.0, 0.8, 0.5}, {0.9, 0.6, 0.3}},
+  [GROK2_GRADIENT_TWILIGHT_PURPLE]   = {{0.4, 0.2, 0.6}, {0.6, 0.4, 0.8}, {0.2, 0.0, 0.4}, {0.4, 0.2, 0.6}},
+  [GROK2_GRADIENT_SUNLIT_MEADOW]     = {{0.4, 0.8, 0.2}, {1.0, 1.0, 0.0}, {0.6, 0.9, 0.4}, {0.4, 0.8, 0.2}},
+  [GROK2_GRADIENT_OCEAN_DEPTHS]      = {{0.0, 0.2, 0.6}, {0.0, 0.4, 0.8}, {0.0, 0.0, 0.4}, {0.0, 0.2, 0.6}},
+  [GROK2_GRADIENT_CHERRY_BLOSSOM]    = {{1.0, 0.7, 0.8}, {1.0, 0.9, 0.9}, {0.8, 0.5, 0.6}, {1.0, 0.7, 0.8}},
+  [GROK2_GRADIENT_EMERALD_DREAM]     = {{0.0, 0.6, 0.4}, {0.2, 0.8, 0.6}, {0.0, 0.4, 0.2}, {0.0, 0.6, 0.4}},
+  [GROK2_GRADIENT_SAPPHIRE_NIGHT]    = {{0.0, 0.2, 0.8}, {0.2, 0.4, 1.0}, {0.0, 0.0, 0.6}, {0.0, 0.2, 0.8}},
+  [GROK2_GRADIENT_RUBY_GLOW]         = {{0.8, 0.2, 0.2}, {1.0, 0.4, 0.4}, {0.6, 0.0, 0.0}, {0.8, 0.2, 0.2}},
+  [GROK2_GRADIENT_AMETHYST_HAZE]     = {{0.6, 0.4, 0.8}, {0.8, 0.6, 1.0}, {0.4, 0.2, 0.6}, {0.6, 0.4, 0.8}},
+  [GROK2_GRADIENT_TOPAZ_SUNSET]      = {{1.0, 0.6, 0.2}, {1.0, 0.8, 0.4}, {0.8, 0.4, 0.0}, {1.0, 0.6, 0.2}},
+  [GROK2_GRADIENT_AQUAMARINE_WAVE]   = {{0.2, 0.8, 0.8}, {0.4, 1.0, 1.0}, {0.0, 0.6, 0.6}, {0.2, 0.8, 0.8}},
+  [GROK2_GRADIENT_COTTON_CANDY]      = {{1.0, 0.8, 0.9}, {0.8, 0.9, 1.0}, {1.0, 0.6, 0.8}, {1.0, 0.8, 0.9}},
+  [GROK2_GRADIENT_SWEET_CANDIES]     = {
+      {1.0, 0.4, 0.6},  // Bright Pink (candyfloss)
+      {0.4, 1.0, 0.6},  // Mint Green (peppermint)
+      {1.0, 0.8, 0.2},  // Lemon Yellow (lemon drop)
+      {0.4, 0.6, 1.0}   // Bubblegum Blue
+    },
+  [GROK2_GRADIENT_STARRY_SKY]        = {{0.0, 0.0, 0.4}, {0.2, 0.2, 0.8}, {0.0, 0.0, 0.6}, {0.0, 0.0, 0.4}},
+  [GROK2_GRADIENT_MOONLIT_FOG]       = {{0.8, 0.8, 1.0}, {0.6, 0.6, 0.8}, {0.9, 0.9, 1.0}, {0.8, 0.8, 1.0}},
+  [GROK2_GRADIENT_SUNFLOWER_FIELD]   = {{1.0, 0.8, 0.0}, {0.4, 0.8, 0.2}, {1.0, 1.0, 0.0}, {1.0, 0.8, 0.0}},
+  [GROK2_GRADIENT_LILAC_DUSK]        = {{0.8, 0.6, 1.0}, {0.6, 0.4, 0.8}, {1.0, 0.8, 1.0}, {0.8, 0.6, 1.0}},
+  [GROK2_GRADIENT_TURQUOISE_TIDE]    = {{0.0, 0.8, 0.8}, {0.2, 1.0, 1.0}, {0.0, 0.6, 0.6}, {0.0, 0.8, 0.8}},
+  [GROK2_GRADIENT_CRIMSON_SKY]       = {{0.8, 0.2, 0.2}, {1.0, 0.4, 0.0}, {0.6, 0.0, 0.0}, {0.8, 0.2, 0.2}},
+  [GROK2_GRADIENT_PERIWINKLE_BREEZE] = {{0.6, 0.6, 1.0}, {0.8, 0.8, 1.0}, {0.4, 0.4, 0.8}, {0.6, 0.6, 1.0}},
+  [GROK2_GRADIENT_GALACTIC_HORIZON]  = {{0.2, 0.0, 0.4}, {0.4, 0.2, 0.8}, {0.0, 0.0, 0.6}, {0.2, 0.0, 0.4}},
+  [GROK2_GRADIENT_PEPPERMINT_TWIST]  = {{1.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, {0.0, 1.0, 0.0}, {1.0, 0.0, 0.0}},
+  [GROK2_GRADIENT_ROSE_QUARTZ]       = {{1.0, 0.7, 0.7}, {0.8, 0.6, 0.6}, {1.0, 0.9, 0.9}, {1.0, 0.7, 0.7}},
+  [GROK2_GRADIENT_MIDNIGHT_BLUE]     = {{0.0, 0.0, 0.6}, {0.0, 0.0, 0.8}, {0.0, 0.0, 0.4}, {0.0, 0.0, 0.6}},
+  [GROK2_GRADIENT_SAFFRON_SUNRISE]   = {{1.0, 0.6, 0.0}, {1.0, 0.8, 0.2}, {1.0, 0.4, 0.0}, {1.0, 0.6, 0.0}},
+  [GROK2_GRADIENT_JADE_MIST]         = {{0.2, 0.8, 0.6}, {0.4, 1.0, 0.8}, {0.0, 0.6, 0.4}, {0.2, 0.8, 0.6}},
+};
+
+// The selected gradient is baked into a table of GRADIENT_LUT_SIZE RGB
+// entries over t = 0..1 with saturation and brightness already applied, so
+// process only has to look colours up.  It is rebuilt when those change.
+//
+// For blending, every entry is also split into the pure colour of its hue
+// plus its saturation and value.  An HSV colour is v * (1 - s * (1 - hue)),
+// so blending the input's saturation and value under the gradient's hue
+// needs neither the input's hue nor a conversion back from HSV.
+#define GRADIENT_LUT_SIZE 4096
+
+typedef struct
+{
+  gboolean          valid;
+  gint              type;
+  gdouble           saturation;
+  gdouble           brightness;
+  gchar            *file;
+  gint64            mtime;
+  gfloat            rgb[GRADIENT_LUT_SIZE * 3];
+  gfloat            hue[GRADIENT_LUT_SIZE * 3];
+  gfloat            sv[GRADIENT_LUT_SIZE * 2];
+} GradientLut;
+
+// Apply saturation and brightness adjustments to a baked table in place
+static void
+adjust_gradient (gfloat *rgb, gfloat saturation, gfloat brightness)
+{
+  for (gint i = 0; i < GRADIENT_LUT_SIZE; i++) {
+    gfloat *c = rgb + i * 3;
+    gfloat  h, s, v;
+
+    rgb_to_hsv(c[0], c[1], c[2], &h, &s, &v);
+    s *= saturation;
+    v *= brightness;
+    hsv_to_rgb(h, s, v, &c[0], &c[1], &c[2]);
+  }
+}
+
+static void
+split_gradient_hsv (GradientLut *lut)
+{
+  for (gint i = 0; i < GRADIENT_LUT_SIZE; i++) {
+    gfloat *c = lut->rgb + i * 3;
+    gfloat *k = lut->hue + i * 3;
+    gfloat  h;
+
+    rgb_to_hsv(c[0], c[1], c[2], &h, &lut->sv[i * 2], &lut->sv[i * 2 + 1]);
+    hsv_to_rgb(h, 1.0, 1.0, &k[0], &k[1], &k[2]);
+  }
+}
+
+static void
+bake_gradient (gfloat *rgb, gint type, gfloat saturation, gfloat brightness)
+{
+  for (gint i = 0; i < GRADIENT_LUT_SIZE; i++) {
+    gfloat  t = (gfloat) i / (GRADIENT_LUT_SIZE - 1);
+    gfloat *c = rgb + i * 3;
+
+    if (type == GROK2_GRADIENT_RAINBOW)
+      // Rainbow Gradient: Use HSV
+      hsv_to_rgb(t * 360.0, saturation, brightness, &c[0], &c[1], &c[2]);
+    else if (type < G_N_ELEMENTS(palette_colors))
+      interpolate_gradient(t, palette_colors[type], palette_stops, PALETTE_STOPS - 1, &c[0], &c[1], &c[2]);
+    else
+      c[0] = c[1] = c[2] = 0.0; // Fallback
+  }
+
+  if (type != GROK2_GRADIENT_RAINBOW)
+    adjust_gradient(rgb, saturation, brightness);
+}
+
+// GIMP .ggr gradients.  Segments are evaluated the way GIMP does and
+// compiled into the same unadjusted table a palette bakes into; the
+// gradient's own alpha is ignored since the op outputs opaque colour.
+#define GGR_EPSILON 1e-10
+
+typedef enum
+{
+  GGR_BLEND_LINEAR,
+  GGR_BLEND_CURVED,
+  GGR_BLEND_SINE,
+  GGR_BLEND_SPHERE_INCREASING,
+  GGR_BLEND_SPHERE_DECREASING,
+  GGR_BLEND_STEP
+} GgrBlend;
+
+typedef enum
+{
+  GGR_COLOR_RGB,
+  GGR_COLOR_HSV_CCW,
+  GGR_COLOR_HSV_CW
+} GgrColor;
+
+typedef struct
+{
+  gdouble  left, middle, right;
+  gfloat   left_rgb[3];
+  gfloat   right_rgb[3];
+  GgrBlend blend;
+  GgrColor color;
+} GgrSegment;
+
+static gdouble
+ggr_linear_factor (gdouble middle, gdouble pos)
+{
+  if (pos <= middle)
+    return middle < GGR_EPSILON ? 0.0 : 0.5 * pos / middle;
+
+  pos -= middle;
+  middle = 1.0 - middle;
+  return middle < GGR_EPSILON ? 1.0 : 0.5 + 0.5 * pos / middle;
+}
+
+static void
+ggr_segment_color (const GgrSegment *seg, gdouble pos, gfloat *rgb)
+{
+  gdouble len = seg->right - seg->left;
+  gdouble middle, factor;
+
+  if (len < GGR_EPSILON) {
+    middle = 0.5;
+    pos = 0.5;
+  } else {
+    middle = (seg->middle - seg->left) / len;
+    pos = (pos - seg->left) / len;
+  }
+
+  switch (seg->blend) {
+    case GGR_BLEND_CURVED:
+      factor = pow(pos, log(0.5) / log(MAX(middle, GGR_EPSILON)));
+      break;
+    case GGR_BLEND_SINE:
+      factor = (sin(-G_PI / 2.0 + G_PI * ggr_linear_factor(middle, pos)) + 1.0) / 2.0;
+      break;
+    case GGR_BLEND_SPHERE_INCREASING:
+      pos = ggr_linear_factor(middle, pos) - 1.0;
+      factor = sqrt(1.0 - pos * pos);
+      break;
+    case GGR_BLEND_SPHERE_DECREASING:
+      pos = ggr_linear_factor(middle, pos);
+      factor = 1.0 - sqrt(1.0 - pos * pos);
+      break;
+    case GGR_BLEND_STEP:
+      factor = pos >= middle ? 1.0 : 0.0;
+      break;
+    default:
+      factor = ggr_linear_factor(middle, pos);
+      break;
+  }
+
+  if (seg->color == GGR_COLOR_RGB) {
+    for (gint c = 0; c < 3; c++)
+      rgb[c] = seg->left_rgb[c] + (seg->right_rgb[c] - seg->left_rgb[c]) * factor;
+  } else {
+    gfloat lh, ls, lv, rh, rs, rv, h;
+
+    rgb_to_hsv(seg->left_rgb[0], seg->left_rgb[1], seg->left_rgb[2], &lh, &ls, &lv);
+    rgb_to_hsv(seg->right_rgb[0], seg->right_rgb[1], seg->right_rgb[2], &rh, &rs, &rv);
+
+    // Walk the hue circle in the segment's direction, hsv_to_rgb wraps it
+    if (seg->color == GGR_COLOR_HSV_CCW)
+      h = lh + (lh < rh ? rh - lh : 360.0 - (lh - rh)) * factor;
+    else
+      h = lh - (rh < lh ? lh - rh : 360.0 - (rh - lh)) * factor;
+
+    hsv_to_rgb(h, ls + (rs - ls) * factor, lv + (rv - lv) * factor, &rgb[0], &rgb[1], &rgb[2]);
+  }
+}
+
+static GgrSegment *
+ggr_parse (const gchar *contents, gint *n_segments)
+{
+  gchar     **lines = g_strsplit(contents, "\n", -1);
+  GgrSegment *segments = NULL;
+  gint        line = 1;
+  gint        n = 0;
+
+  if (!lines[0] || !g_str_has_prefix(lines[0], "GIMP Gradient"))
+    goto out;
+
+  if (lines[line] && g_str_has_prefix(lines[line], "Name:"))
+    line++;
+  if (!lines[line])
+    goto out;
+
+  n = atoi(lines[line++]);
+  if (n <= 0)
+    goto out;
+
+  segments = g_new0(GgrSegment, n);
+  for (gint i = 0; i < n; i++, line++) {
+    GgrSegment *seg = &segments[i];
+    gdouble     values[11];
+    gchar      *p = lines[line];
+    gchar      *end = NULL;
+    gint        j;
+
+    for (j = 0; p && j < 11; j++, p = end) {
+      values[j] = g_ascii_strtod(p, &end);
+      if (end == p)
+        break;
+    }
+    if (j < 11) {
+      n = 0;
+      break;
+    }
+
+    seg->left = values[0];
+    seg->middle = values[1];
+    seg->right = values[2];
+    for (gint c = 0; c < 3; c++) {
+      seg->left_rgb[c] = values[3 + c];
+      seg->right_rgb[c] = values[7 + c];
+    }
+    seg->blend = CLAMP(strtol(p, &end, 10), GGR_BLEND_LINEAR, GGR_BLEND_STEP);
+    seg->color = CLAMP(strtol(end, NULL, 10), GGR_COLOR_RGB, GGR_COLOR_HSV_CW);
+  }
+
+  if (n <= 0)
+    g_clear_pointer(&segments, g_free);
+
+out:
+  g_strfreev(lines);
+  *n_segments = n;
+  return segments;
+}
+
+static void
+ggr_compile (const GgrSegment *segments, gint n_segments, gfloat *rgb)
+{
+  gint seg = 0;
+
+  for (gint i = 0; i < GRADIENT_LUT_SIZE; i++) {
+    gdouble pos = (gdouble) i / (GRADIENT_LUT_SIZE - 1);
+
+    while (seg < n_segments - 1 && pos > segments[seg].right)
+      seg++;
+    ggr_segment_color(&segments[seg], pos, rgb + i * 3);
+  }
+}
+
+// Cache of compiled .ggr files keyed by path and checked against the
+// file's mtime, so batch runs parse each gradient once per module.
+typedef struct
+{
+  gint64 mtime;
+  gfloat rgb[GRADIENT_LUT_SIZE * 3];
+} GgrCacheEntry;
+
+G_LOCK_DEFINE_STATIC (ggr_cache);
+static GHashTable *ggr_cache = NULL;
+
+static gboolean
+ggr_cache_load (const gchar *path, gint64 mtime, gfloat *rgb)
+{
+  GgrCacheEntry *entry;
+  gboolean       success = FALSE;
+
+  G_LOCK (ggr_cache);
+
+  if (!ggr_cache)
+    ggr_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+  entry = g_hash_table_lookup(ggr_cache, path);
+  if (!entry || entry->mtime != mtime) {
+    gchar      *contents = NULL;
+    GgrSegment *segments = NULL;
+    gint        n_segments = 0;
+
+    if (g_file_get_contents(path, &contents, NULL, NULL))
+      segments = ggr_parse(contents, &n_segments);
+
+    if (segments) {
+      entry = g_new(GgrCacheEntry, 1);
+      entry->mtime = mtime;
+      ggr_compile(segments, n_segments, entry->rgb);
+      g_hash_table_replace(ggr_cache, g_strdup(path), entry);
+    } else {
+      entry = NULL;
+    }
+
+    g_free(segments);
+    g_free(contents);
+  }
+
+  if (entry) {
+    memcpy(rgb, entry->rgb, sizeof (entry->rgb));
+    success = TRUE;
+  }
+
+  G_UNLOCK (ggr_cache);
+
+  return success;
+}
+
+static void
+update_gradient_lut (GradientLut *lut, GeglProperties *o)
+{
+  const gchar *file = o->gradient_file ? o->gradient_file : "";
+  gint64       mtime = -1;
+  GStatBuf     st;
+
+  if (*file && g_stat(file, &st) == 0)
+    mtime = st.st_mtime;
+
+  if (lut->valid &&
+      lut->type == o->gradient_type &&
+      lut->saturation == o->saturation &&
+      lut->brightness == o->brightness &&
+      lut->mtime == mtime &&
+      g_strcmp0(lut->file, file) == 0)
+    return;
+
+  if (*file && mtime >= 0 && ggr_cache_load(file, mtime, lut->rgb)) {
+    adjust_gradient(lut->rgb, o->saturation, o->brightness);
+  } else {
+    if (*file)
+      g_warning("could not load gradient file '%s'", file);
+    bake_gradient(lut->rgb, o->gradient_type, o->saturation, o->brightness);
+  }
+  split_gradient_hsv(lut);
+
+  g_free(lut->file);
+  lut->file = g_strdup(file);
+  lut->mtime = mtime;
+  lut->type = o->gradient_type;
+  lut->saturation = o->saturation;
+  lut->brightness = o->brightness;
+  lut->valid = TRUE;
+}
+
+// The table index of every pixel depends only on the geometry, so it is
+// kept for the whole canvas and filled one canvas row at a time as chunks
+// ask for it.  Changing only the palette, saturation or blend then re-maps
+// cached indices instead of evaluating the shape again.
+#define GRADIENT_FIELD_MAX_PIXELS (64 * 1024 * 1024)
+
+typedef struct
+{
+  gint               shape;
+  gfloat             angle_rad;
+  gfloat             cos_a, sin_a;
+  gfloat             freq;
+  gfloat             offset_x, offset_y;
+  gfloat             width, height;
+} GradientGeometry;
+
+typedef struct
+{
+  GradientGeometry geometry;
+  GrokRowCache     rows;
+} GradientField;
+
+typedef struct
+{
+  GradientLut   lut;
+  GradientField field;
+} GradientCache;
+
+static void
+init_gradient_geometry (GradientGeometry *g, GeglProperties *o, gfloat width, gfloat height)
+{
+  memset(g, 0, sizeof (*g));
+  g->shape = o->gradient_shape;
+
+  // Precompute angle in radians
+  g->angle_rad = o->angle * G_PI / 180.0;
+  g->cos_a = cosf(g->angle_rad);
+  g->sin_a = sinf(g->angle_rad);
+
+  // Select frequency based on shape
+  g->freq = (o->gradient_shape == GROK2_SHAPE_SPIRAL || o->gradient_shape == GROK2_SHAPE_SPIRAL_CCW) ? (gfloat)o->frequency_2 : o->frequency;
+
+  // Convert percentage offsets to normalized offsets
+  g->offset_x = o->offset_x / 100.0;
+  g->offset_y = o->offset_y / 100.0;
+
+  g->width = width;
+  g->height = height;
+}
+
+static inline guint16
+gradient_index (gfloat t)
+{
+  // Ensure t is in [0,1] for seamlessness
+  t = fmodf(t, 1.0);
+  if (t < 0.0)
+    t += 1.0;
+
+  return (guint16) (t * (GRADIENT_LUT_SIZE - 1) + 0.5f);
+}
+
+// Table indices for n pixels of row y starting at column x
+GROK_KERNEL
+static void
+gradient_field_row (const GradientGeometry *g, gint x, gint y, gint n, guint16 *index)
+{
+  // Compute normalized coordinates, centered at (0.5, 0.5) with offset
+  gfloat fy = y / g->height - 0.5 - g->offset_y;
+  gfloat freq = g->freq;
+
+  switch (g->shape) {
+    case GROK2_SHAPE_LINEAR:
+    case GROK2_SHAPE_BILINEAR:
+      {
+        // Linear in x, so step along the row instead of projecting each pixel
+        gfloat fx = x / g->width - 0.5 - g->offset_x;
+        gfloat t0 = (fx * g->cos_a + fy * g->sin_a) * freq;
+        gfloat dt = g->cos_a / g->width * freq;
+
+        if (g->shape == GROK2_SHAPE_LINEAR)
+          for (gint i = 0; i < n; i++)
+            index[i] = gradient_index(t0 + i * dt + 0.5 * freq);
+        else
+          for (gint i = 0; i < n; i++)
+            index[i] = gradient_index(fabsf(t0 + i * dt));
+      }
+      break;
+    case GROK2_SHAPE_RADIAL:
+      for (gint i = 0; i < n; i++) {
+        gfloat fx = (x + i) / g->width - 0.5 - g->offset_x;
+        index[i] = gradient_index(sqrtf(fx * fx + fy * fy) * freq);
+      }
+      break;
+    case GROK2_SHAPE_SPIRAL:
+    case GROK2_SHAPE_SPIRAL_CCW:
+      {
+        // Reverse direction for the counter-clockwise spiral
+        gfloat dir = g->shape == GROK2_SHAPE_SPIRAL ? 1.0 : -1.0;
+
+        for (gint i = 0; i < n; i++) {
+          gfloat fx = (x + i) / g->width - 0.5 - g->offset_x;
+          gfloat r = sqrtf(fx * fx + fy * fy);
+          gfloat theta = dir * atan2f(fy, fx) + g->angle_rad; // Include rotation
+          // Create seamless spiral using periodic function
+          index[i] = gradient_index(0.5 * (1.0 + sinf(2.0 * G_PI * freq * (theta / (2.0 * G_PI) + r))));
+        }
+      }
+      break;
+    case GROK2_SHAPE_SQUARE:
+      for (gint i = 0; i < n; i++) {
+        gfloat fx = (x + i) / g->width - 0.5 - g->offset_x;
+        index[i] = gradient_index(fmaxf(fabsf(fx), fabsf(fy)) * freq);
+      }
+      break;
+    default:
+      memset(index, 0, n * sizeof (guint16));
+      break;
+  }
+}
+
+static void
+gradient_fill_row (gconstpointer key, gint x, gint y, gint n, gpointer row)
+{
+  gradient_field_row(key, x, y, n, row);
+}
+
+static void
+update_gradient_field (GradientField *field, GeglProperties *o, const GeglRectangle *canvas)
+{
+  GradientGeometry geometry;
+
+  // Without a bounded canvas the geometry follows each roi, nothing to keep
+  if (!grok_row_cache_fits(canvas, GRADIENT_FIELD_MAX_PIXELS)) {
+    grok_row_cache_clear(&field->rows);
+    return;
+  }
+
+  init_gradient_geometry(&geometry, o, canvas->width, canvas->height);
+
+  if (field->rows.data &&
+      gegl_rectangle_equal(&field->rows.canvas, canvas) &&
+      memcmp(&field->geometry, &geometry, sizeof (geometry)) == 0)
+    return;
+
+  field->geometry = geometry;
+  grok_row_cache_reset(&field->rows, canvas, sizeof (guint16));
+}
+
+static void
+gradient_cache_free (GradientCache *cache)
+{
+  if (!cache)
+    return;
+
+  g_free (cache->lut.file);
+  grok_row_cache_clear (&cache->field.rows);
+  g_free (cache);
+}
+
+static GradientCache *
+gradient_cache_update (GradientCache *cache, GeglProperties *o, const GeglRectangle *canvas)
+{
+  if (!cache)
+    cache = g_new0 (GradientCache, 1);
+
+  update_gradient_lut(&cache->lut, o);
+  update_gradient_field(&cache->field, o, canvas);
+
+  return cache;
+}
+
+// Sets up the geometry of a chunk and tells whether the cached field was
+// built for that same geometry and covers roi
+static gboolean
+gradient_field_covers (GradientField *field, GradientGeometry *geometry, GeglProperties *o,
+                       const GeglRectangle *canvas, const GeglRectangle *roi)
+{
+  gfloat width = canvas ? canvas->width : roi->width;
+  gfloat height = canvas ? canvas->height : roi->height;
+
+  init_gradient_geometry(geometry, o, width, height);
+
+  return canvas && grok_row_cache_covers(&field->rows, roi) &&
+         memcmp(&field->geometry, geometry, sizeof (*geometry)) == 0;
+}
+
+// Table indices for n pixels of row y starting at column x, from the
+// cached field when it was built for this geometry, else computed into
+// scratch, which is allocated on first use and freed by the caller
+static const guint16 *
+gradient_row_index (GradientField *field, const GradientGeometry *geometry, gboolean cached,
+                    gint x, gint y, gint n, guint16 **scratch)
+{
+  const guint16 *row_index = NULL;
+
+  if (cached)
+    row_index = grok_row_cache_fetch(&field->rows, x, y, gradient_fill_row, &field->geometry);
+  if (!row_index) {
+    if (!*scratch)
+      *scratch = g_new(guint16, n);
+    gradient_field_row(geometry, x, y, n, *scratch);
+    row_index = *scratch;
+  }
+
+  return row_index;
+}
+
+// Maps n RGBA pixels through the baked gradient, in place if in == out
+GROK_KERNEL
+static void
+gradient_map_row (const GradientLut *lut, const guint16 *row_index,
+                  const gfloat *in_pixel, gfloat *out_pixel, gint n,
+                  gdouble blend, gboolean alpha_lock)
+{
+  for (gint col = 0; col < n; col++)
+    {
+      // Look up the baked gradient colour
+      gint index = row_index[col];
+      const gfloat *grad = lut->rgb + index * 3;
+      gfloat grad_r = grad[0];
+      gfloat grad_g = grad[1];
+      gfloat grad_b = grad[2];
+
+      // Get input pixel color
+      gfloat in_r = in_pixel[0];
+      gfloat in_g = in_pixel[1];
+      gfloat in_b = in_pixel[2];
+      gfloat in_a = in_pixel[3];
+
+      // Initialize output RGB and alpha
+      gfloat final_r, final_g, final_b, final_a;
+
+      if (blend == 0.0) {
+        // No blending: use gradient color directly
+        final_r = grad_r;
+        final_g = grad_g;
+        final_b = grad_b;
+        final_a = alpha_lock ? in_a : 1.0;
+      } else {
+        // Saturation and brightness of the input pixel, its hue is not needed
+        gfloat in_max = fmaxf(fmaxf(CLAMP(in_r, 0.0, 1.0), CLAMP(in_g, 0.0, 1.0)), CLAMP(in_b, 0.0, 1.0));
+        gfloat in_min = fminf(fminf(CLAMP(in_r, 0.0, 1.0), CLAMP(in_g, 0.0, 1.0)), CLAMP(in_b, 0.0, 1.0));
+        gfloat in_s = in_max > 0.0 ? (in_max - in_min) / in_max : 0.0;
+        gfloat in_v = in_max;
+
+        // Blend in HSV space
+        // Use gradient's hue, interpolate saturation and brightness
+        const gfloat *grad_hue = lut->hue + index * 3; // Always use gradient's hue for Rainbowify effect
+        const gfloat *grad_sv = lut->sv + index * 2;
+        gfloat final_s = in_s * (1.0 - blend) + grad_sv[0] * blend;
+        gfloat final_v = in_v * (1.0 - blend) + grad_sv[1] * blend;
+
+        // Rebuild RGB from the gradient's pure hue colour
+        gfloat chroma = final_v * final_s;
+        final_r = final_v - chroma * (1.0 - grad_hue[0]);
+        final_g = final_v - chroma * (1.0 - grad_hue[1]);
+        final_b = final_v - chroma * (1.0 - grad_hue[2]);
+
+        // Handle alpha channel
+        final_a = in_a; // Default to input alpha
+        if (!alpha_lock) {
+          // If alpha_lock is disabled, set output alpha to 1.0 (opaque)
+          final_a = 1.0;
+        } else if (in_a < 1.0) {
+          // If alpha_lock is enabled and input is transparent, blend towards input
+          final_r = final_r * in_a + in_r * (1.0 - in_a);
+          final_g = final_g * in_a + in_g * (1.0 - in_a);
+          final_b = final_b * in_a + in_b * (1.0 - in_a);
+        }
+      }
+
+      // Write output pixel
+      out_pixel[0] = final_r;
+      out_pixel[1] = final_g;
+      out_pixel[2] = final_b;
+      out_pixel[3] = final_a;
+
+      // Move to next pixel
+      in_pixel += 4;
+      out_pixel += 4;
+    }
+}
+
+#endif /* __GROK_GRADIENT_H__ */
@@ -0,0 +1,35 @@
+/* grok-kernel.h
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* GROK_KERNEL marks a hot loop for function multi-versioning.  When the
+ * build enables it the compiler emits an AVX-512, AVX2, SSE4.2 and
+ * baseline clone, and the loader picks the widest one the CPU supports,
+ * so a single module runs near its best on any x86-64 machine.
+ * Elsewhere it expands to nothing.
+ */
+
+#ifndef __GROK_KERNEL_H__
+#define __GROK_KERNEL_H__
+
+#if defined (HAVE_FUNCTION_MULTIVERSIONING) && defined (ARCH_X86_64)
+#define GROK_KERNEL __attribute__ ((target_clones ("avx512f", "avx2", "sse4.2", "default")))
+#else
+#define GROK_KERNEL
+#endif
+
+#endif /* __GROK_KERNEL_H__ */
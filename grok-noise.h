@@ -0,0 +1,151 @@
+/* grok-noise.h
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Hash noise shared by the pattern generators.
+ *
+ * Values are a pure function of integer lattice coordinates and a seed,
+ * computed with 32-bit integer arithmetic only, so every platform, thread
+ * and tile gets the same bits and tiled renders stitch without seams.
+ * The mixing follows xxHash32: each input word is folded in with a
+ * multiply and rotate, then the result is avalanched.
+ */
+
+#ifndef __GROK_NOISE_H__
+#define __GROK_NOISE_H__
+
+#include <glib.h>
+
+#define GROK_NOISE_PRIME2 0x85ebca77u
+#define GROK_NOISE_PRIME3 0xc2b2ae3du
+#define GROK_NOISE_PRIME4 0x27d4eb2fu
+#define GROK_NOISE_PRIME5 0x165667b1u
+
+static inline guint32
+grok_noise_rotl (guint32 v, gint r)
+{
+  return (v << r) | (v >> (32 - r));
+}
+
+static inline guint32
+grok_noise_round (guint32 h, guint32 v)
+{
+  return grok_noise_rotl (h + v * GROK_NOISE_PRIME3, 17) * GROK_NOISE_PRIME4;
+}
+
+static inline guint32
+grok_noise_avalanche (guint32 h)
+{
+  h ^= h >> 15;
+  h *= GROK_NOISE_PRIME2;
+  h ^= h >> 13;
+  h *= GROK_NOISE_PRIME3;
+  h ^= h >> 16;
+  return h;
+}
+
+/* 32 random bits for lattice point (x, y) */
+static inline guint32
+grok_hash2 (gint32 x, gint32 y, guint32 seed)
+{
+  guint32 h = seed + GROK_NOISE_PRIME5 + 8;
+
+  h = grok_noise_round (h, (guint32) x);
+  h = grok_noise_round (h, (guint32) y);
+  return grok_noise_avalanche (h);
+}
+
+/* 32 random bits for lattice point (x, y) in an independent channel z */
+static inline guint32
+grok_hash3 (gint32 x, gint32 y, gint32 z, guint32 seed)
+{
+  guint32 h = seed + GROK_NOISE_PRIME5 + 12;
+
+  h = grok_noise_round (h, (guint32) x);
+  h = grok_noise_round (h, (guint32) y);
+  h = grok_noise_round (h, (guint32) z);
+  return grok_noise_avalanche (h);
+}
+
+/* Map the top 24 bits of a hash to [0, 1), exactly representable */
+static inline gfloat
+grok_noise_unit (guint32 h)
+{
+  return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline gfloat
+grok_noise2 (gint32 x, gint32 y, guint32 seed)
+{
+  return grok_noise_unit (grok_hash2 (x, y, seed));
+}
+
+static inline gfloat
+grok_noise3 (gint32 x, gint32 y, gint32 z, guint32 seed)
+{
+  return grok_noise_unit (grok_hash3 (x, y, z, seed));
+}
+
+/* grok_noise2 for n consecutive points (x0 .. x0 + n - 1, y).  With GCC
+ * vector extensions eight lanes are hashed at once, which maps to
+ * SSE/AVX2 or NEON; the result is bit-identical to the scalar path.
+ */
+#if defined (__GNUC__) && (__GNUC__ >= 9 || defined (__clang__))
+typedef guint32 GrokNoiseVec __attribute__ ((vector_size (32)));
+typedef gfloat  GrokNoiseVecf __attribute__ ((vector_size (32)));
+#define GROK_NOISE_HAVE_VECTOR 1
+#endif
+
+static inline void
+grok_noise2_row (gint32   x0,
+                 gint32   y,
+                 guint32  seed,
+                 gfloat  *out,
+                 gint     n)
+{
+  gint i = 0;
+
+#ifdef GROK_NOISE_HAVE_VECTOR
+  const GrokNoiseVec lanes = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  guint32            hy = seed + GROK_NOISE_PRIME5 + 8;
+
+  for (; i + 8 <= n; i += 8)
+    {
+      GrokNoiseVec  h = hy + ((guint32) (x0 + i) + lanes) * GROK_NOISE_PRIME3;
+      GrokNoiseVecf f;
+      gint          j;
+
+      h = ((h << 17) | (h >> 15)) * GROK_NOISE_PRIME4;
+      h = h + (guint32) y * GROK_NOISE_PRIME3;
+      h = ((h << 17) | (h >> 15)) * GROK_NOISE_PRIME4;
+      h ^= h >> 15;
+      h *= GROK_NOISE_PRIME2;
+      h ^= h >> 13;
+      h *= GROK_NOISE_PRIME3;
+      h ^= h >> 16;
+
+      f = __builtin_convertvector (h >> 8, GrokNoiseVecf) * (1.0f / 16777216.0f);
+      for (j = 0; j < 8; j++)
+        out[i + j] = f[j];
+    }
+#endif
+
+  for (; i < n; i++)
+    out[i] = grok_noise2 (x0 + i, y, seed);
+}
+
+#endif /* __GROK_NOISE_H__ */
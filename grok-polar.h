@@ -0,0 +1,143 @@
+/* grok-polar.h
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Polar coordinates shared by the radial point filters.
+ *
+ * A pixel's angle around the centre and its radius normalized by
+ * max_radius depend only on the canvas and the centre, so they are kept
+ * in a GrokRowCache for the whole canvas.  Changing colours, twist or
+ * phase then re-shades cached values instead of calling atan2 and sqrt
+ * again.
+ */
+
+#ifndef __GROK_POLAR_H__
+#define __GROK_POLAR_H__
+
+#include <math.h>
+#include <gegl.h>
+#include "grok-row-cache.h"
+
+#define GROK_POLAR_MAX_PIXELS (16 * 1024 * 1024)
+
+typedef struct
+{
+  gfloat       cx, cy;
+  gfloat       max_radius;
+  GrokRowCache rows;       /* angle in [0, 2pi) and normalized radius */
+} GrokPolarField;
+
+/* Angle and normalized radius of n pixels of row y starting at column x.
+ * This still costs an atan2f and a sqrtf per pixel; the saving is that
+ * the field runs it once per canvas row rather than on every render.
+ */
+static inline void
+grok_polar_row (gfloat  cx,
+                gfloat  cy,
+                gfloat  max_radius,
+                gint    x,
+                gint    y,
+                gint    n,
+                gfloat *polar)
+{
+  gfloat dy = y - cy;
+  gfloat dy2 = dy * dy;
+  gfloat dx = x - cx;
+  gfloat inv_radius = 1.0f / max_radius;
+  gint   i;
+
+  for (i = 0; i < n; i++, dx += 1.0f)
+    {
+      gfloat angle = atan2f (dy, dx);
+
+      if (angle < 0.0f)
+        angle += 2.0f * G_PI;
+
+      polar[i * 2 + 0] = angle;
+      polar[i * 2 + 1] = sqrtf (dx * dx + dy2) * inv_radius;
+    }
+}
+
+static inline void
+grok_polar_fill_row (gconstpointer key,
+                     gint          x,
+                     gint          y,
+                     gint          n,
+                     gpointer      row)
+{
+  const GrokPolarField *field = key;
+
+  grok_polar_row (field->cx, field->cy, field->max_radius, x, y, n, row);
+}
+
+/* Keeps the field for this canvas and centre, dropping it when either
+ * changed or the canvas is unbounded or too large to keep.
+ */
+static inline void
+grok_polar_field_update (GrokPolarField      *field,
+                         const GeglRectangle *canvas,
+                         gfloat               cx,
+                         gfloat               cy,
+                         gfloat               max_radius)
+{
+  if (!grok_row_cache_fits (canvas, GROK_POLAR_MAX_PIXELS))
+    {
+      grok_row_cache_clear (&field->rows);
+      return;
+    }
+
+  if (field->rows.data &&
+      gegl_rectangle_equal (&field->rows.canvas, canvas) &&
+      field->cx == cx && field->cy == cy && field->max_radius == max_radius)
+    return;
+
+  field->cx = cx;
+  field->cy = cy;
+  field->max_radius = max_radius;
+  grok_row_cache_reset (&field->rows, canvas, 2 * sizeof (gfloat));
+}
+
+/* Whether rows of roi can be fetched from a field built for this centre */
+static inline gboolean
+grok_polar_field_covers (const GrokPolarField *field,
+                         const GeglRectangle  *roi,
+                         gfloat                cx,
+                         gfloat                cy,
+                         gfloat                max_radius)
+{
+  return field->cx == cx && field->cy == cy && field->max_radius == max_radius &&
+         grok_row_cache_covers (&field->rows, roi);
+}
+
+/* Cached polar pairs of row y from column x on, or NULL while another
+ * thread fills the row
+ */
+static inline const gfloat *
+grok_polar_field_fetch_row (GrokPolarField *field,
+                            gint            x,
+                            gint            y)
+{
+  return grok_row_cache_fetch (&field->rows, x, y, grok_polar_fill_row, field);
+}
+
+static inline void
+grok_polar_field_clear (GrokPolarField *field)
+{
+  grok_row_cache_clear (&field->rows);
+}
+
+#endif /* __GROK_POLAR_H__ */
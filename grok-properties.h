@@ -0,0 +1,234 @@
+/* grok-properties.h
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Property lists of the stages an op can share with another.
+ *
+ * An op that runs another op's stage declares the same properties by
+ * expanding its list inside its own GEGL_PROPERTIES block, so the stage's
+ * code in grok-diffuse.h or grok-gradient.h reads the same fields of
+ * either op's GeglProperties.  GObject enum types are global, so every op
+ * passes its own names for the enums a list declares:
+ *
+ *   #ifdef GEGL_PROPERTIES
+ *   GROK_DIFFUSE_PROPERTIES (SmoothSolver, smooth_solver)
+ *   #else
+ *
+ * Include this with the other headers, before GEGL_PROPERTIES is tested.
+ */
+
+#ifndef __GROK_PROPERTIES_H__
+#define __GROK_PROPERTIES_H__
+
+/* Anisotropic diffusion, see grok-diffuse.h */
+#define GROK_DIFFUSE_PROPERTIES(SolverEnum, solver_func) \
+  enum_start (solver_func) \
+    enum_value (SMOOTH_SOLVER_EXPLICIT, "explicit", N_("Explicit")) \
+    enum_value (SMOOTH_SOLVER_AOS,      "aos",      N_("Semi-implicit (AOS)")) \
+  enum_end (SolverEnum) \
+ \
+  property_int (iterations, _("Iterations"), 10) \
+    description (_("Number of iterations; more iterations cause stronger smoothing")) \
+    value_range (1, 20) \
+    ui_range (1, 15) \
+ \
+  property_double (alpha, _("Alpha"), 0.6) \
+    description (_("Diffusion strength in homogeneous regions")) \
+    value_range (0.1, 1.0) \
+    ui_range (0.1, 0.8) \
+ \
+  property_double (kappa, _("Kappa"), 4.0) \
+    description (_("Edge sensitivity parameter; lower values preserve sharper edges")) \
+    value_range (1.0, 15.0) \
+    ui_range (1.0, 10.0) \
+ \
+  property_double (strength, _("Strength"), 2.5) \
+    description (_("Overall intensity of the smoothing effect")) \
+    value_range (0.5, 5.0) \
+    ui_range (0.5, 4.0) \
+ \
+  property_double (delta_t, _("Delta T"), 0.3) \
+    description (_("Time step for numerical stability")) \
+    value_range (0.05, 0.5) \
+    ui_range (0.05, 0.4) \
+ \
+  property_enum (solver, _("Solver"), \
+                 SolverEnum, solver_func, SMOOTH_SOLVER_EXPLICIT) \
+    description (_("Explicit takes iterations small steps; semi-implicit covers the same diffusion time (iterations x delta T) in a few large, unconditionally stable steps")) \
+ \
+  property_int (pyramid_levels, _("Pyramid levels"), 0) \
+    description (_("Run most of the diffusion on this many half-size levels and bring it back with edge-guided upsampling; 0 diffuses at full resolution only")) \
+    value_range (0, 4) \
+ \
+  property_boolean (full_frame, _("Full-frame reference"), FALSE) \
+    description (_("Diffuse the whole image in one piece instead of tile by tile; slower, meant for checking the tiled result")) \
+ \
+  property_int (strip_rows, _("Strip rows"), 0) \
+    description (_("Work through each region in horizontal bands of this many rows, keeping only one band and its context in memory and writing the output band by band; for images larger than RAM. 0 diffuses each region in one piece")) \
+    value_range (0, 65536) \
+    ui_range (0, 4096)
+
+/* Gradient mapping, see grok-gradient.h */
+#define GROK_GRADIENT_PROPERTIES(TypeEnum, type_func, ShapeEnum, shape_func) \
+  enum_start (type_func) \
+    enum_value(GROK2_GRADIENT_RAINBOW, "rainbow", N_("Rainbow Gradient")) \
+    enum_value(GROK2_GRADIENT_TROPICAL, "tropical", N_("Tropical Colors")) \
+    enum_value(GROK2_GRADIENT_BERRY_BLAST, "berry_blast", N_("Berry Blast")) \
+    enum_value(GROK2_GRADIENT_CITRUS_ZEST, "citrus_zest", N_("Citrus Zest")) \
+    enum_value(GROK2_GRADIENT_MANGO_TANGO, "mango_tango", N_("Mango Tango")) \
+    enum_value(GROK2_GRADIENT_MELON_MEDLEY, "melon_medley", N_("Melon Medley")) \
+    enum_value(GROK2_GRADIENT_PEACH_DREAM, "peach_dream", N_("Peach Dream")) \
+    enum_value(GROK2_GRADIENT_PINEAPPLE_PUNCH, "pineapple_punch", N_("Pineapple Punch")) \
+    enum_value(GROK2_GRADIENT_TROPICAL_BREEZE, "tropical_breeze", N_("Tropical Breeze")) \
+    enum_value(GROK2_GRADIENT_GOLDEN, "golden", N_("Golden")) \
+    enum_value(GROK2_GRADIENT_SUNRISE, "sunrise", N_("Sunrise")) \
+    enum_value(GROK2_GRADIENT_ABSTRACT_1, "abstract_1", N_("Abstract 1")) \
+    enum_value(GROK2_GRADIENT_ABSTRACT_2, "abstract_2", N_("Abstract 2")) \
+    enum_value(GROK2_GRADIENT_ABSTRACT_3, "abstract_3", N_("Abstract 3")) \
+    enum_value(GROK2_GRADIENT_BLUUE_SUNSET, "blue_sunset", N_("Blue Sunset")) \
+    enum_value(GROK2_GRADIENT_FIRE_GLOW, "fire_glow", N_("Fire Glow")) \
+    enum_value(GROK2_GRADIENT_OCEAN_WAVE, "ocean_wave", N_("Ocean Wave")) \
+    enum_value(GROK2_GRADIENT_FOREST_GLADE, "forest_glade", N_("Forest Glade")) \
+    enum_value(GROK2_GRADIENT_PASTEL_DREAM, "pastel_dream", N_("Pastel Dream")) \
+    enum_value(GROK2_GRADIENT_NEON_GLOW, "neon_glow", N_("Neon Glow")) \
+    enum_value(GROK2_GRADIENT_AUTUMN_LEAVES, "autumn_leaves", N_("Autumn Leaves")) \
+    enum_value(GROK2_GRADIENT_PURPLE_HAZE, "purple_haze", N_("Purple Haze")) \
+    enum_value(GROK2_GRADIENT_DESERT_SAND, "desert_sand", N_("Desert Sand")) \
+    enum_value(GROK2_GRADIENT_ICY_FROST, "icy_frost", N_("Icy Frost")) \
+    enum_value(GROK2_GRADIENT_CANDY_SWIRL, "candy_swirl", N_("Candy Swirl")) \
+    enum_value(GROK2_GRADIENT_VIOLET_DUSK, "violet_dusk", N_("Violet Dusk")) \
+    enum_value(GROK2_GRADIENT_GREEN_LIME, "green_lime", N_("Green Lime")) \
+    enum_value(GROK2_GRADIENT_RED_SUNSET, "red_sunset", N_("Red Sunset")) \
+    enum_value(GROK2_GRADIENT_BLUE_LAGOON, "blue_lagoon", N_("Blue Lagoon")) \
+    enum_value(GROK2_GRADIENT_PINK_SUNRISE, "pink_sunrise", N_("Pink Sunrise")) \
+    enum_value(GROK2_GRADIENT_COOL_BREEZE, "cool_breeze", N_("Cool Breeze")) \
+    enum_value(GROK2_GRADIENT_WARM_GLOW, "warm_glow", N_("Warm Glow")) \
+    enum_value(GROK2_GRADIENT_LAVENDER_MIST, "lavender_mist", N_("Lavender Mist")) \
+    enum_value(GROK2_GRADIENT_SKY_BLUE, "sky_blue", N_("Sky Blue")) \
+    enum_value(GROK2_GRADIENT_RAINBOW_CYCLE, "rainbow_cycle", N_("Rainbow Cycle")) \
+    enum_value(GROK2_GRADIENT_SUNSET_GLOW, "sunset_glow", N_("Sunset Glow")) \
+    enum_value(GROK2_GRADIENT_MINT_FRESH, "mint_fresh", N_("Mint Fresh")) \
+    enum_value(GROK2_GRADIENT_CORAL_REEF, "coral_reef", N_("Coral Reef")) \
+    enum_value(GROK2_GRADIENT_ELECTRIC_PULSE, "electric_pulse", N_("Electric Pulse")) \
+    enum_value(GROK2_GRADIENT_GOLD_SHIMMER, "gold_shimmer", N_("Gold Shimmer")) \
+    enum_value(GROK2_GRADIENT_GOLD_RADIANCE, "gold_radiance", N_("Gold Radiance")) \
+    enum_value(GROK2_GRADIENT_SILVER_GLEAM, "silver_gleam", N_("Silver Gleam")) \
+    enum_value(GROK2_GRADIENT_SILVER_LUSTER, "silver_luster", N_("Silver Luster")) \
+    enum_value(GROK2_GRADIENT_BRONZE_GLOW, "bronze_glow", N_("Bronze Glow")) \
+    enum_value(GROK2_GRADIENT_BRONZE_SHEEN, "bronze_sheen", N_("Bronze Sheen")) \
+    enum_value(GROK2_GRADIENT_TWILIGHT_PURPLE, "twilight_purple", N_("Twilight Purple")) \
+    enum_value(GROK2_GRADIENT_SUNLIT_MEADOW, "sunlit_meadow", N_("Sunlit Meadow")) \
+    enum_value(GROK2_GRADIENT_OCEAN_DEPTHS, "ocean_depths", N_("Ocean Depths")) \
+    enum_value(GROK2_GRADIENT_CHERRY_BLOSSOM, "cherry_blossom", N_("Cherry Blossom")) \
+    enum_value(GROK2_GRADIENT_EMERALD_DREAM, "emerald_dream", N_("Emerald Dream")) \
+    enum_value(GROK2_GRADIENT_SAPPHIRE_NIGHT, "sapphire_night", N_("Sapphire Night")) \
+    enum_value(GROK2_GRADIENT_RUBY_GLOW, "ruby_glow", N_("Ruby Glow")) \
+    enum_value(GROK2_GRADIENT_AMETHYST_HAZE, "amethyst_haze", N_("Amethyst Haze")) \
+    enum_value(GROK2_GRADIENT_TOPAZ_SUNSET, "topaz_sunset", N_("Topaz Sunset")) \
+    enum_value(GROK2_GRADIENT_AQUAMARINE_WAVE, "aquamarine_wave", N_("Aquamarine Wave")) \
+    enum_value(GROK2_GRADIENT_COTTON_CANDY, "cotton_candy", N_("Cotton Candy")) \
+    enum_value(GROK2_GRADIENT_SWEET_CANDIES, "sweet_candies", N_("Sweet Candies")) \
+    enum_value(GROK2_GRADIENT_STARRY_SKY, "starry_sky", N_("Starry Sky")) \
+    enum_value(GROK2_GRADIENT_MOONLIT_FOG, "moonlit_fog", N_("Moonlit Fog")) \
+    enum_value(GROK2_GRADIENT_SUNFLOWER_FIELD, "sunflower_field", N_("Sunflower Field")) \
+    enum_value(GROK2_GRADIENT_LILAC_DUSK, "lilac_dusk", N_("Lilac Dusk")) \
+    enum_value(GROK2_GRADIENT_TURQUOISE_TIDE, "turquoise_tide", N_("Turquoise Tide")) \
+    enum_value(GROK2_GRADIENT_CRIMSON_SKY, "crimson_sky", N_("Crimson Sky")) \
+    enum_value(GROK2_GRADIENT_PERIWINKLE_BREEZE, "periwinkle_breeze", N_("Periwinkle Breeze")) \
+    enum_value(GROK2_GRADIENT_GALACTIC_HORIZON, "galactic_horizon", N_("Galactic Horizon")) \
+    enum_value(GROK2_GRADIENT_PEPPERMINT_TWIST, "peppermint_twist", N_("Peppermint Twist")) \
+    enum_value(GROK2_GRADIENT_ROSE_QUARTZ, "rose_quartz", N_("Rose Quartz")) \
+    enum_value(GROK2_GRADIENT_MIDNIGHT_BLUE, "midnight_blue", N_("Midnight Blue")) \
+    enum_value(GROK2_GRADIENT_SAFFRON_SUNRISE, "saffron_sunrise", N_("Saffron Sunrise")) \
+    enum_value(GROK2_GRADIENT_JADE_MIST, "jade_mist", N_("Jade Mist")) \
+  enum_end (TypeEnum) \
+ \
+  enum_start (shape_func) \
+    enum_value(GROK2_SHAPE_LINEAR, "linear", N_("Linear")) \
+    enum_value(GROK2_SHAPE_BILINEAR, "bilinear", N_("Bilinear")) \
+    enum_value(GROK2_SHAPE_RADIAL, "radial", N_("Radial")) \
+    enum_value(GROK2_SHAPE_SPIRAL, "spiral", N_("Spiral")) \
+    enum_value(GROK2_SHAPE_SPIRAL_CCW, "spiral_ccw", N_("Spiral Counter-Clockwise")) \
+    enum_value(GROK2_SHAPE_SQUARE, "square", N_("Square")) \
+  enum_end (ShapeEnum) \
+ \
+  property_enum (gradient_type, _("Gradient Type"), \
+                 TypeEnum, type_func, \
+                 GROK2_GRADIENT_RAINBOW) \
+      description (_("Type of gradient to apply")) \
+ \
+  property_file_path (gradient_file, _("Gradient File"), "") \
+      description (_("GIMP gradient (.ggr) to use instead of the built-in gradient type")) \
+ \
+  property_enum (gradient_shape, _("Gradient Shape"), \
+                 ShapeEnum, shape_func, \
+                 GROK2_SHAPE_LINEAR) \
+      description (_("Shape of the gradient pattern")) \
+ \
+  property_double (angle, _("Gradient Angle"), 0.0) \
+      description (_("Angle of the gradient in degrees (affects Linear and Bilinear shapes; rotates starting point for Spiral shapes)")) \
+      value_range (0.0, 360.0) \
+      ui_range (0.0, 360.0) \
+      ui_meta ("unit", "degree") \
+      ui_meta ("direction", "ccw") \
+      ui_meta ("visible", "!gradient_shape{radial,square}") \
+ \
+  property_double (frequency, _("Frequency"), 1.0) \
+      description (_("Number of gradient cycles across the image")) \
+      value_range (0.1, 10.0) \
+      ui_range (0.1, 5.0) \
+      ui_meta ("visible", "!gradient_shape{spiral,spiral_ccw}") \
+ \
+  property_int (frequency_2, _("Spiral Frequency"), 1) \
+      description (_("Number of spiral gradient cycles across the image (whole numbers for seamless spirals)")) \
+      value_range (1, 10) \
+      ui_range (1, 10) \
+      ui_meta ("visible", "gradient_shape{spiral,spiral_ccw}") \
+ \
+  property_double (saturation, _("Saturation"), 1.0) \
+      description (_("Color intensity (0.0 = grayscale, 1.0 = full color)")) \
+      value_range (0.0, 1.0) \
+      ui_range (0.5, 1.0) \
+ \
+  property_double (brightness, _("Brightness"), 1.0) \
+      description (_("Color brightness (0.0 = dark, 1.0 = bright)")) \
+      value_range (0.0, 1.0) \
+      ui_range (0.5, 1.0) \
+ \
+  property_double (offset_x, _("X Offset"), 0.0) \
+      description (_("Horizontal offset of the gradient center (as a percentage of image width, -100 to 100)")) \
+      value_range (-100.0, 100.0) \
+      ui_range (-100.0, 100.0) \
+      ui_meta ("unit", "percent") \
+ \
+  property_double (offset_y, _("Y Offset"), 0.0) \
+      description (_("Vertical offset of the gradient center (as a percentage of image height, -100 to 100)")) \
+      value_range (-100.0, 100.0) \
+      ui_range (-100.0, 100.0) \
+      ui_meta ("unit", "percent") \
+ \
+  property_double (blend, _("Blend"), 0.0) \
+      description (_("Blending with the input image")) \
+      value_range (0.0, 0.1) \
+      ui_range (0.0, 0.1) \
+      ui_meta ("unit", "percent") \
+      ui_meta     ("role", "output-extent") \
+ \
+  property_boolean (alpha_lock, _("Lock Alpha Channel"), FALSE) \
+      description (_("Lock the alpha channel to preserve the input image’s transparency (when enabled, gradient does not affect transparent areas)"))
+
+#endif /* __GROK_PROPERTIES_H__ */
@@ -0,0 +1,117 @@
+/* grok-row-cache.h
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Per-pixel values kept for a whole canvas and filled lazily.
+ *
+ * The first chunk to reach a canvas row computes all of it and claims it
+ * with an atomic state flag; a chunk that finds the row being filled by
+ * another thread computes its own pixels instead of waiting.  The owner
+ * decides when the values are stale and resets the cache.
+ */
+
+#ifndef __GROK_ROW_CACHE_H__
+#define __GROK_ROW_CACHE_H__
+
+#include <gegl.h>
+
+enum
+{
+  GROK_ROW_EMPTY,
+  GROK_ROW_BUSY,
+  GROK_ROW_READY
+};
+
+typedef struct
+{
+  GeglRectangle canvas;
+  gsize         pixel_size;
+  guint8       *data;
+  gint         *row_state;
+} GrokRowCache;
+
+/* Computes n pixels of row y starting at column x into row */
+typedef void (*GrokRowFillFunc) (gconstpointer key,
+                                 gint          x,
+                                 gint          y,
+                                 gint          n,
+                                 gpointer      row);
+
+static inline void
+grok_row_cache_clear (GrokRowCache *cache)
+{
+  g_clear_pointer (&cache->data, g_free);
+  g_clear_pointer (&cache->row_state, g_free);
+}
+
+/* Whether canvas is bounded and has at most max_pixels pixels */
+static inline gboolean
+grok_row_cache_fits (const GeglRectangle *canvas,
+                     gint64               max_pixels)
+{
+  return canvas && !gegl_rectangle_is_empty (canvas) &&
+         !gegl_rectangle_is_infinite_plane (canvas) &&
+         (gint64) canvas->width * canvas->height <= max_pixels;
+}
+
+/* Allocates the cache for canvas with every row empty */
+static inline void
+grok_row_cache_reset (GrokRowCache        *cache,
+                      const GeglRectangle *canvas,
+                      gsize                pixel_size)
+{
+  grok_row_cache_clear (cache);
+  cache->canvas = *canvas;
+  cache->pixel_size = pixel_size;
+  cache->data = g_malloc ((gsize) canvas->width * canvas->height * pixel_size);
+  cache->row_state = g_new0 (gint, canvas->height);
+}
+
+static inline gboolean
+grok_row_cache_covers (const GrokRowCache  *cache,
+                       const GeglRectangle *roi)
+{
+  return cache->data && gegl_rectangle_contains (&cache->canvas, roi);
+}
+
+/* Cached pixels of row y from column x on, filling the row with fill
+ * first if nobody has, or NULL while another thread fills it
+ */
+static inline gconstpointer
+grok_row_cache_fetch (GrokRowCache    *cache,
+                      gint             x,
+                      gint             y,
+                      GrokRowFillFunc  fill,
+                      gconstpointer    key)
+{
+  gint   *state = &cache->row_state[y - cache->canvas.y];
+  guint8 *row = cache->data +
+                (gsize) (y - cache->canvas.y) * cache->canvas.width * cache->pixel_size;
+
+  if (g_atomic_int_get (state) != GROK_ROW_READY)
+    {
+      if (!g_atomic_int_compare_and_exchange (state, GROK_ROW_EMPTY, GROK_ROW_BUSY))
+        return NULL;
+
+      fill (key, cache->canvas.x, y, cache->canvas.width, row);
+      g_atomic_int_set (state, GROK_ROW_READY);
+    }
+
+  return row + (gsize) (x - cache->canvas.x) * cache->pixel_size;
+}
+
+#endif /* __GROK_ROW_CACHE_H__ */
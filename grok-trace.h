@@ -0,0 +1,341 @@
+/* grok-trace.h
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Opt-in instrumentation shared by the ops.
+ *
+ * Tracing is off unless GROK_TRACE is set in the environment, as a comma
+ * separated list of:
+ *
+ *   summary        per-op totals on stderr when the process exits
+ *   log            one stderr line per process call
+ *   chrome=FILE    every call as a Chrome trace event (chrome://tracing,
+ *                  Perfetto), written when the process exits
+ *
+ * Any other non-empty value means summary.  Each op registers from
+ * class_init and brackets its process function with a span:
+ *
+ *   grok_trace_begin (&span, trace_op, roi, level);
+ *   ...
+ *   grok_trace_scratch (&span, bytes);
+ *   grok_trace_end (&span, n_pixels);
+ *
+ * When tracing is off the op handle is NULL and a span costs one
+ * predictable branch.  Every module is its own shared object, so the
+ * registry is kept on the GeglConfig singleton, where the first op to
+ * register leaves it for the others.
+ */
+
+#ifndef __GROK_TRACE_H__
+#define __GROK_TRACE_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gegl.h>
+#include <gegl-plugin.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#endif
+
+#define GROK_TRACE_REGISTRY_KEY "grok-trace-registry-1"
+#define GROK_TRACE_MAX_EVENTS   (1 << 20)
+
+typedef struct _GrokTraceRegistry GrokTraceRegistry;
+
+typedef struct
+{
+  GrokTraceRegistry *registry;
+  const gchar       *name;
+  guint64            calls;
+  guint64            pixels;
+  guint64            scratch_bytes;
+  guint64            iterations;
+  gint64             total_us;
+  gint64             max_us;
+} GrokTraceOp;
+
+typedef struct
+{
+  GrokTraceOp   *op;
+  GeglRectangle  roi;
+  gint64         start;
+  gint64         duration;
+  gint           tid;
+  gint           level;
+  guint64        iterations;
+  guint64        scratch_bytes;
+  guint64        pixels;
+} GrokTraceEvent;
+
+struct _GrokTraceRegistry
+{
+  GMutex      lock;
+  gint64      origin;
+  gboolean    summary;
+  gboolean    log;
+  gchar      *chrome_path;
+  GPtrArray  *ops;
+  GArray     *events;
+  guint64     dropped;
+};
+
+typedef struct
+{
+  GrokTraceOp    *op;
+  GrokTraceEvent  event;
+} GrokTraceSpan;
+
+static inline gint
+grok_trace_thread_id (void)
+{
+  return (gint) ((GPOINTER_TO_SIZE (g_thread_self ()) >> 4) & 0x7fffffff);
+}
+
+static inline void
+grok_trace_write_summary (GrokTraceRegistry *registry)
+{
+  guint i;
+
+  fprintf (stderr, "grok-trace: %-32s %8s %12s %10s %9s %9s %9s %10s %10s\n",
+           "op", "calls", "pixels", "total ms", "mean ms", "max ms",
+           "Mpix/s", "scratch MB", "iterations");
+
+  for (i = 0; i < registry->ops->len; i++)
+    {
+      GrokTraceOp *op = g_ptr_array_index (registry->ops, i);
+
+      if (!op->calls)
+        continue;
+
+      fprintf (stderr, "grok-trace: %-32s %8" G_GUINT64_FORMAT " %12" G_GUINT64_FORMAT
+               " %10.2f %9.3f %9.3f %9.2f %10.2f %10" G_GUINT64_FORMAT "\n",
+               op->name, op->calls, op->pixels,
+               op->total_us / 1000.0,
+               op->total_us / 1000.0 / op->calls,
+               op->max_us / 1000.0,
+               op->total_us ? op->pixels / (gdouble) op->total_us : 0.0,
+               op->scratch_bytes / (1024.0 * 1024.0),
+               op->iterations);
+    }
+
+  if (registry->dropped)
+    fprintf (stderr, "grok-trace: %" G_GUINT64_FORMAT " events dropped\n",
+             registry->dropped);
+}
+
+static inline void
+grok_trace_write_chrome (GrokTraceRegistry *registry)
+{
+  FILE *file = fopen (registry->chrome_path, "w");
+  gint  pid = 0;
+  guint i;
+
+  if (!file)
+    {
+      fprintf (stderr, "grok-trace: could not write '%s'\n", registry->chrome_path);
+      return;
+    }
+
+#ifdef G_OS_UNIX
+  pid = getpid ();
+#endif
+
+  fputs ("{\"traceEvents\":[\n", file);
+  for (i = 0; i < registry->events->len; i++)
+    {
+      GrokTraceEvent *event = &g_array_index (registry->events, GrokTraceEvent, i);
+
+      fprintf (file,
+               "%s{\"name\":\"%s\",\"cat\":\"gegl\",\"ph\":\"X\","
+               "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ","
+               "\"pid\":%d,\"tid\":%d,\"args\":{"
+               "\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d,\"level\":%d,"
+               "\"pixels\":%" G_GUINT64_FORMAT ",\"scratch_bytes\":%" G_GUINT64_FORMAT ","
+               "\"iterations\":%" G_GUINT64_FORMAT "}}\n",
+               i ? "," : "",
+               event->op->name,
+               event->start - registry->origin,
+               event->duration,
+               pid, event->tid,
+               event->roi.x, event->roi.y, event->roi.width, event->roi.height,
+               event->level, event->pixels, event->scratch_bytes,
+               event->iterations);
+    }
+  fputs ("],\"displayTimeUnit\":\"ms\"}\n", file);
+  fclose (file);
+}
+
+static GrokTraceRegistry *grok_trace_registry;
+
+static inline void
+grok_trace_exit (void)
+{
+  GrokTraceRegistry *registry = grok_trace_registry;
+
+  g_mutex_lock (&registry->lock);
+  if (registry->summary)
+    grok_trace_write_summary (registry);
+  if (registry->chrome_path)
+    grok_trace_write_chrome (registry);
+  g_mutex_unlock (&registry->lock);
+}
+
+static inline GrokTraceRegistry *
+grok_trace_registry_new (const gchar *spec)
+{
+  GrokTraceRegistry  *registry = g_new0 (GrokTraceRegistry, 1);
+  gchar             **tokens = g_strsplit (spec, ",", -1);
+  gint                i;
+
+  g_mutex_init (&registry->lock);
+  registry->origin = g_get_monotonic_time ();
+  registry->ops = g_ptr_array_new ();
+  registry->events = g_array_new (FALSE, FALSE, sizeof (GrokTraceEvent));
+
+  for (i = 0; tokens[i]; i++)
+    {
+      if (!strcmp (tokens[i], "log"))
+        registry->log = TRUE;
+      else if (g_str_has_prefix (tokens[i], "chrome="))
+        registry->chrome_path = g_strdup (tokens[i] + strlen ("chrome="));
+      else
+        registry->summary = TRUE;
+    }
+  g_strfreev (tokens);
+
+  return registry;
+}
+
+/* The per-op handle for an op class whose keys are already set, or NULL
+ * when tracing is off.  Call from class_init.
+ */
+static inline GrokTraceOp *
+grok_trace_register (GeglOperationClass *operation_class)
+{
+  const gchar       *spec = g_getenv ("GROK_TRACE");
+  GObject           *config;
+  GrokTraceRegistry *registry;
+  GrokTraceOp       *op;
+
+  if (!spec || !*spec)
+    return NULL;
+
+  config = G_OBJECT (gegl_config ());
+  registry = g_object_get_data (config, GROK_TRACE_REGISTRY_KEY);
+  if (!registry)
+    {
+      registry = grok_trace_registry_new (spec);
+      g_object_set_data (config, GROK_TRACE_REGISTRY_KEY, registry);
+
+      /* Modules stay resident, so the handler outlives its module */
+      grok_trace_registry = registry;
+      atexit (grok_trace_exit);
+    }
+
+  op = g_new0 (GrokTraceOp, 1);
+  op->registry = registry;
+  op->name = g_intern_string (gegl_operation_class_get_key (operation_class, "name"));
+
+  g_mutex_lock (&registry->lock);
+  g_ptr_array_add (registry->ops, op);
+  g_mutex_unlock (&registry->lock);
+
+  return op;
+}
+
+static inline void
+grok_trace_begin (GrokTraceSpan       *span,
+                  GrokTraceOp         *op,
+                  const GeglRectangle *roi,
+                  gint                 level)
+{
+  span->op = op;
+  if (G_LIKELY (!op))
+    return;
+
+  memset (&span->event, 0, sizeof (span->event));
+  span->event.op = op;
+  span->event.roi = *roi;
+  span->event.level = level;
+  span->event.tid = grok_trace_thread_id ();
+  span->event.start = g_get_monotonic_time ();
+}
+
+/* Bytes of temporary buffers the call allocated */
+static inline void
+grok_trace_scratch (GrokTraceSpan *span,
+                    gsize          bytes)
+{
+  if (G_UNLIKELY (span->op))
+    span->event.scratch_bytes += bytes;
+}
+
+/* Solver iterations or passes the call ran */
+static inline void
+grok_trace_iterations (GrokTraceSpan *span,
+                       guint          iterations)
+{
+  if (G_UNLIKELY (span->op))
+    span->event.iterations += iterations;
+}
+
+static inline void
+grok_trace_end (GrokTraceSpan *span,
+                guint64        pixels)
+{
+  GrokTraceOp       *op = span->op;
+  GrokTraceRegistry *registry;
+  gint64             duration;
+
+  if (G_LIKELY (!op))
+    return;
+
+  registry = op->registry;
+  duration = g_get_monotonic_time () - span->event.start;
+  span->event.duration = duration;
+  span->event.pixels = pixels;
+
+  g_mutex_lock (&registry->lock);
+
+  op->calls++;
+  op->pixels += pixels;
+  op->scratch_bytes += span->event.scratch_bytes;
+  op->iterations += span->event.iterations;
+  op->total_us += duration;
+  op->max_us = MAX (op->max_us, duration);
+
+  if (registry->chrome_path)
+    {
+      if (registry->events->len < GROK_TRACE_MAX_EVENTS)
+        g_array_append_val (registry->events, span->event);
+      else
+        registry->dropped++;
+    }
+
+  g_mutex_unlock (&registry->lock);
+
+  if (registry->log)
+    fprintf (stderr, "grok-trace: %s %dx%d%+d%+d level %d, %" G_GUINT64_FORMAT
+             " pixels, %.3f ms\n",
+             op->name, span->event.roi.width, span->event.roi.height,
+             span->event.roi.x, span->event.roi.y, span->event.level,
+             pixels, duration / 1000.0);
+}
+
+#endif /* __GROK_TRACE_H__ */
@@ -19,8 +19,10 @@
 #include "config.h"
 #include <glib/gi18n-lib.h>
 #include <math.h>
+#include <string.h>
 #include <gegl.h>
-#include <stdio.h> /* For console debugging */
+#include "grok-noise.h"
+#include "grok-trace.h"
 
 #ifdef GEGL_PROPERTIES
 
@@ -52,6 +54,9 @@ property_int (seed, _("Random Seed"), 0)
   value_range (0, G_MAXINT)
   ui_range (0, 1000)
 
+property_boolean (infinite_plane, _("Infinite Plane"), FALSE)
+  description (_("Render on an unbounded plane instead of a 1024x1024 canvas"))
+
 #else
 
 #define GEGL_OP_SOURCE
@@ -66,19 +71,96 @@ prepare (GeglOperation *operation)
   gegl_operation_set_format (operation, "output", babl_format ("RGBA float"));
 }
 
+static GrokTraceOp *trace_op;
+
 static GeglRectangle
 get_bounding_box (GeglOperation *operation)
 {
-  /* Default to a reasonable size if no input; adjust as needed */
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+
+  /* Dots are a pure function of world coordinates, so the plane can be
+   * unbounded; otherwise default to a reasonable size */
+  if (o->infinite_plane)
+    return gegl_rectangle_infinite_plane ();
+
   return (GeglRectangle){0, 0, 1024, 1024};
 }
 
-/* Simple noise function for random variation */
+/* Dots live on a grid of dot_spacing sized cells, one dot per cell, with
+ * position, size and colour drawn from a hash of the cell coordinates and
+ * the seed.  A chunk only visits the cells whose dots can reach it, so
+ * tiles render independently and a dot does not depend on the ROI it was
+ * requested in.
+ */
+typedef struct
+{
+  gfloat cx, cy;
+  gfloat radius;
+  gfloat color[3];
+} Dot;
+
+/* Per-cell random value for one attribute channel */
 static gfloat
-noise (gfloat x, gfloat y, gint seed)
+cell_random (gint i, gint j, gint seed, gint channel)
 {
-  gfloat val = sinf (x * 12.9898f + y * 78.233f + seed) * 43758.5453f;
-  return val - floorf(val);
+  return grok_noise3 (i, j, channel, seed);
+}
+
+static void
+cell_dot (GeglProperties *o,
+          const gdouble  *color,
+          gint            i,
+          gint            j,
+          Dot            *dot)
+{
+  /* Random dot center inside its cell */
+  dot->cx = (i + cell_random (i, j, o->seed, 0)) * o->dot_spacing;
+  dot->cy = (j + cell_random (i, j, o->seed, 1)) * o->dot_spacing;
+
+  /* Random size variation */
+  gfloat size_factor = 1.0f + o->size_variation * (cell_random (i, j, o->seed, 2) - 0.5f);
+  dot->radius = o->dot_size * 0.5f * size_factor;
+
+  /* Random color variation */
+  for (gint k = 0; k < 3; k++)
+    dot->color[k] = CLAMP((gfloat)color[k] + o->color_variation * (cell_random (i, j, o->seed, 3 + k) - 0.5f), 0.0f, 1.0f);
+}
+
+static void
+render_dot (gfloat              *out_data,
+            const GeglRectangle *roi,
+            const Dot           *dot)
+{
+  gint x0 = MAX ((gint) floorf (dot->cx - dot->radius), roi->x);
+  gint y0 = MAX ((gint) floorf (dot->cy - dot->radius), roi->y);
+  gint x1 = MIN ((gint) ceilf (dot->cx + dot->radius), roi->x + roi->width);
+  gint y1 = MIN ((gint) ceilf (dot->cy + dot->radius), roi->y + roi->height);
+  gint x, y;
+
+  for (y = y0; y < y1; y++)
+    for (x = x0; x < x1; x++)
+      {
+        gint offset = ((y - roi->y) * roi->width + (x - roi->x)) * 4;
+
+        /* Compute distance from dot center */
+        gfloat dx = x - dot->cx;
+        gfloat dy = y - dot->cy;
+        gfloat dist = sqrtf (dx * dx + dy * dy);
+
+        /* Circular dot with smooth edges */
+        gfloat alpha = CLAMP(1.0f - dist / dot->radius, 0.0f, 1.0f);
+        if (alpha > 0.0f)
+          {
+            gfloat dest_alpha = out_data[offset + 3];
+            gfloat final_alpha = alpha + dest_alpha * (1.0f - alpha);
+            if (final_alpha > 0.0f)
+              {
+                for (gint j = 0; j < 3; j++)
+                  out_data[offset + j] = (dot->color[j] * alpha + out_data[offset + j] * dest_alpha * (1.0f - alpha)) / final_alpha;
+                out_data[offset + 3] = final_alpha;
+              }
+          }
+      }
 }
 
 static gboolean
@@ -90,109 +172,54 @@ process (GeglOperation       *operation,
   GeglProperties *o = GEGL_PROPERTIES (operation);
   const Babl *format = babl_format ("RGBA float");
   GeglBufferIterator *iter;
+  GrokTraceSpan span;
+  const gint factor = 1 << level;
 
   if (result->width < 1 || result->height < 1)
     return TRUE;
 
-  /* Clear output buffer to transparent */
-  iter = gegl_buffer_iterator_new (output, result, 0, format,
+  /* Dot parameters */
+  gfloat spacing = o->dot_spacing;
+  gfloat reach = o->dot_size * 0.5f * (1.0f + 0.5f * o->size_variation);
+  gdouble color[3];
+  gegl_color_get_rgba (o->dot_color, &color[0], &color[1], &color[2], NULL);
+
+  grok_trace_begin (&span, trace_op, result, level);
+
+  iter = gegl_buffer_iterator_new (output, result, level, format,
                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
   while (gegl_buffer_iterator_next (iter))
     {
       gfloat *out_data = iter->items[0].data;
       GeglRectangle roi = iter->items[0].roi;
-      gint x, y;
 
-      for (y = 0; y < roi.height; y++)
-        for (x = 0; x < roi.width; x++)
-          {
-            gint offset = (y * roi.width + x) * 4;
-            out_data[offset + 0] = 0.0f;
-            out_data[offset + 1] = 0.0f;
-            out_data[offset + 2] = 0.0f;
-            out_data[offset + 3] = 0.0f;
-          }
-    }
+      /* Cells whose dots can overlap this chunk, in full resolution
+       * coordinates so every mipmap level shows the same dots */
+      gint i0 = (gint) floorf ((roi.x * factor - reach) / spacing);
+      gint j0 = (gint) floorf ((roi.y * factor - reach) / spacing);
+      gint i1 = (gint) floorf (((roi.x + roi.width) * factor + reach) / spacing);
+      gint j1 = (gint) floorf (((roi.y + roi.height) * factor + reach) / spacing);
+      gint i, j;
 
-  /* Dot parameters */
-  gfloat spacing = o->dot_spacing;
-  gfloat base_radius = o->dot_size * 0.5f;
-  gint max_dots = 10000; /* Cap to prevent performance issues */
-  gint num_dots = MIN((gint)((result->width * result->height) / (spacing * spacing)), max_dots);
-  gdouble color[3];
-  gegl_color_get_rgba (o->dot_color, &color[0], &color[1], &color[2], NULL);
+      /* Clear to transparent */
+      memset (out_data, 0, sizeof (gfloat) * 4 * roi.width * roi.height);
 
-  /* Debug dot count */
-  fprintf(stderr, "Grok: Rendering %d polka dots with seed %d\n", num_dots, o->seed);
+      /* Render polka dots in cell order */
+      for (j = j0; j <= j1; j++)
+        for (i = i0; i <= i1; i++)
+          {
+            Dot dot;
 
-  /* Render polka dots */
-  for (gint i = 0; i < num_dots; i++)
-    {
-      /* Random dot center using noise with seed */
-      gfloat cx = result->x + result->width * noise(i, 0.0f, o->seed);
-      gfloat cy = result->y + result->height * noise(0.0f, i, o->seed);
-      cx = CLAMP(cx, result->x, result->x + result->width - 1);
-      cy = CLAMP(cy, result->y, result->y + result->height - 1);
-
-      /* Random size variation */
-      gfloat size_factor = 1.0f + o->size_variation * (noise(i, 1.0f, o->seed) - 0.5f);
-      gfloat radius = base_radius * size_factor;
-
-      /* Random color variation */
-      gfloat dot_color[3];
-      for (gint j = 0; j < 3; j++)
-        dot_color[j] = CLAMP((gfloat)color[j] + o->color_variation * (noise(i, (gfloat)j, o->seed) - 0.5f), 0.0f, 1.0f);
-
-      /* Define bounding box for the dot */
-      gint dot_size = (gint)(radius * 2.0f);
-      GeglRectangle dot_roi = {
-        .x = (gint)(cx - radius),
-        .y = (gint)(cy - radius),
-        .width = dot_size,
-        .height = dot_size
-      };
-      dot_roi.x = CLAMP(dot_roi.x, result->x, result->x + result->width - dot_roi.width);
-      dot_roi.y = CLAMP(dot_roi.y, result->y, result->y + result->height - dot_roi.height);
-
-      /* Render dot */
-      iter = gegl_buffer_iterator_new (output, &dot_roi, 0, format,
-                                      GEGL_ACCESS_READWRITE, GEGL_ABYSS_NONE, 1);
-      while (gegl_buffer_iterator_next (iter))
-        {
-          gfloat *out_data = iter->items[0].data;
-          GeglRectangle roi = iter->items[0].roi;
-          gint x, y;
-
-          for (y = 0; y < roi.height; y++)
-            for (x = 0; x < roi.width; x++)
-              {
-                gint offset = (y * roi.width + x) * 4;
-                gfloat px = x + roi.x;
-                gfloat py = y + roi.y;
-
-                /* Compute distance from dot center */
-                gfloat dx = px - cx;
-                gfloat dy = py - cy;
-                gfloat dist = sqrtf (dx * dx + dy * dy);
-
-                /* Circular dot with smooth edges */
-                gfloat alpha = CLAMP(1.0f - dist / radius, 0.0f, 1.0f);
-                if (alpha > 0.0f)
-                  {
-                    gfloat dest_alpha = out_data[offset + 3];
-                    gfloat final_alpha = alpha + dest_alpha * (1.0f - alpha);
-                    if (final_alpha > 0.0f)
-                      {
-                        for (gint j = 0; j < 3; j++)
-                          out_data[offset + j] = (dot_color[j] * alpha + out_data[offset + j] * dest_alpha * (1.0f - alpha)) / final_alpha;
-                        out_data[offset + 3] = final_alpha;
-                      }
-                  }
-              }
-        }
+            cell_dot (o, color, i, j, &dot);
+            dot.cx /= factor;
+            dot.cy /= factor;
+            dot.radius /= factor;
+            render_dot (out_data, &roi, &dot);
+          }
     }
 
-  fprintf(stderr, "Grok: Polka dots rendered\n");
+  grok_trace_end (&span, (guint64) result->width * result->height);
+
   return TRUE;
 }
 
@@ -203,17 +230,21 @@ gegl_op_class_init (GeglOpClass *klass)
   GeglOperationSourceClass *source_class = GEGL_OPERATION_SOURCE_CLASS (klass);
 
   operation_class->prepare = prepare;
+  operation_class->threaded = TRUE;
   operation_class->get_bounding_box = get_bounding_box;
   source_class->process = process;
 
   gegl_operation_class_set_keys (operation_class,
-    "name",        "gegl:grok",
+    "name",        "grok:polka-dots",
     "title",       _("Grok Polka Dots"),
     "categories",  "render:pattern",
     "description", _("Generates a random polka dots pattern with variable size and color"),
     "gimp:menu-path", "<Image>/Filters/Render/Pattern/",
     "gimp:menu-label", _("Grok Polka Dots"),
+    "position-dependent", "true",
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
@@ -41,7 +41,8 @@ property_color (color2, _("Color 2"), "#800080")
 #define GEGL_OP_NAME     grok2
 #define GEGL_OP_C_SOURCE grok2.c
 
-#endif /* GEGL_PROPERTIES */
+#include "gegl-op.h"
+#include "grok-trace.h"
 
 /* Operation implementation */
 static void
@@ -56,6 +57,8 @@ get_bounding_box (GeglOperation *operation)
   return gegl_rectangle_infinite_plane ();
 }
 
+static GrokTraceOp *trace_op;
+
 static gboolean
 process (GeglOperation       *operation,
          GeglOperationContext *context,
@@ -65,6 +68,10 @@ process (GeglOperation       *operation,
 {
   GeglProperties *o = GEGL_PROPERTIES (operation);
   GeglBuffer *output = gegl_operation_context_get_target (context, "output");
+  GrokTraceSpan span;
+
+  grok_trace_begin (&span, trace_op, result, level);
+  grok_trace_scratch (&span, (gsize) result->width * result->height * 4 * sizeof (gfloat));
 
   gfloat *out_pixel = g_new (gfloat, result->width * result->height * 4);
   gfloat *out_ptr = out_pixel;
@@ -107,11 +114,13 @@ process (GeglOperation       *operation,
 
   gegl_buffer_set (output, result, 0, babl_format ("RGBA float"), out_pixel, GEGL_AUTO_ROWSTRIDE);
   g_free (out_pixel);
+  grok_trace_end (&span, (guint64) result->width * result->height);
+
   return TRUE;
 }
 
 static void
-gegl_op_class_init (GeglOperationClass *klass)
+gegl_op_class_init (GeglOpClass *klass)
 {
   GeglOperationClass *operation_class = GEGL_OPERATION_CLASS (klass);
 
@@ -120,9 +129,13 @@ gegl_op_class_init (GeglOperationClass *klass)
   operation_class->process = process;
 
   gegl_operation_class_set_keys (operation_class,
-    "name",        "gegl:grok2",
+    "name",        "grok:zebra-stripes",
     "title",       _("Zebra Stripes"),
     "categories",  "render:artistic",
     "description", _("Generates a zebra stripe pattern with adjustable zoom, position, angle, and colors"),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
+
+#endif
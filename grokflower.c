@@ -1,4 +1,4 @@
-/* hawaiian_flowers.c
+/* grokflower.c
  *
  * Copyright (C) 2025 LinuxBeaver and contributors
  *
@@ -19,6 +19,7 @@
 #include "config.h"
 #include <glib/gi18n-lib.h>
 #include <math.h>
+#include "grok-noise.h"
 
 #ifdef GEGL_PROPERTIES
 
@@ -56,10 +57,11 @@ property_color (center_color, _("Center Color"), "#ffff00")
 #else
 
 #define GEGL_OP_FILTER
-#define GEGL_OP_NAME     grok
-#define GEGL_OP_C_SOURCE grok.c
+#define GEGL_OP_NAME     grokflower
+#define GEGL_OP_C_SOURCE grokflower.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
 
 static void
 prepare (GeglOperation *operation)
@@ -84,12 +86,7 @@ get_required_for_output (GeglOperation       *operation,
   return get_bounding_box (operation);
 }
 
-/* Simple noise function for random variation */
-static gfloat
-noise (gfloat x, gfloat y)
-{
-  return sinf (x * 12.9898f + y * 78.233f) * 43758.5453f - floorf (sinf (x * 12.9898f + y * 78.233f) * 43758.5453f);
-}
+static GrokTraceOp *trace_op;
 
 static gboolean
 process (GeglOperation       *operation,
@@ -101,6 +98,7 @@ process (GeglOperation       *operation,
   GeglProperties *o = GEGL_PROPERTIES (operation);
   const Babl *format = babl_format ("RGBA float");
   GeglBufferIterator *iter;
+  GrokTraceSpan span;
 
   if (result->width < 1 || result->height < 1)
     {
@@ -109,6 +107,8 @@ process (GeglOperation       *operation,
       return TRUE;
     }
 
+  grok_trace_begin (&span, trace_op, result, level);
+
   iter = gegl_buffer_iterator_new (input, result, 0, format,
                                   GEGL_ACCESS_READ, GEGL_ABYSS_CLAMP, 2);
   gegl_buffer_iterator_add (iter, output, result, 0, format,
@@ -153,9 +153,9 @@ process (GeglOperation       *operation,
             gfloat dist = sqrtf (dx * dx + dy * dy);
 
             /* Alternate between large and small flowers */
-            gfloat seed = noise (cx / period, cy / period);
             gfloat row = floorf (py / period);
             gfloat col = floorf ((px - row_offset) / period);
+            gfloat seed = grok_noise2 ((gint) col, (gint) row, 0);
             gfloat size_factor = (fmodf (row + col, 2.0f) < 1.0f) ? 1.0f : o->size_ratio;
 
             gfloat petal_radius = base_radius * size_factor;
@@ -212,6 +212,8 @@ process (GeglOperation       *operation,
           }
     }
 
+  grok_trace_end (&span, (guint64) result->width * result->height);
+
   return TRUE;
 }
 
@@ -227,13 +229,15 @@ gegl_op_class_init (GeglOpClass *klass)
   filter_class->process            = process;
 
   gegl_operation_class_set_keys (operation_class,
-    "name",        "gegl:hawaiian_flowers",
+    "name",        "grok:hawaiian-flowers-overlay",
     "title",       _("Hawaiian Flowers Pattern"),
     "categories",  "render:pattern",
     "description", _("Renders a stylized Hawaiian flower pattern with teardrop-shaped petals in a staggered grid, against a transparent background"),
     "gimp:menu-path", "<Image>/Filters/Render/Pattern",
     "gimp:menu-label", _("Hawaiian Flowers Pattern"),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
@@ -1,4 +1,4 @@
-/* grok.c
+/* hawaiian.c
  *
  * Copyright (C) 2025 LinuxBeaver and contributors
  *
@@ -60,6 +60,8 @@ property_color (center_color, _("Center Color"), "#ffff00")
 #define GEGL_OP_C_SOURCE hawaiian.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
+#include "grok-flowers.h"
 
 static void
 prepare (GeglOperation *operation)
@@ -84,12 +86,7 @@ get_required_for_output (GeglOperation       *operation,
   return get_bounding_box (operation);
 }
 
-/* Simple noise function for random variation */
-static gfloat
-noise (gfloat x, gfloat y)
-{
-  return sinf (x * 12.9898f + y * 78.233f) * 43758.5453f - floorf (sinf (x * 12.9898f + y * 78.233f) * 43758.5453f);
-}
+static GrokTraceOp *trace_op;
 
 static gboolean
 process (GeglOperation       *operation,
@@ -101,6 +98,8 @@ process (GeglOperation       *operation,
   GeglProperties *o = GEGL_PROPERTIES (operation);
   const Babl *format = babl_format ("RGBA float");
   GeglBufferIterator *iter;
+  GrokTraceSpan span;
+  FlowerPattern pattern;
 
   if (result->width < 1 || result->height < 1)
     {
@@ -109,101 +108,26 @@ process (GeglOperation       *operation,
       return TRUE;
     }
 
+  grok_trace_begin (&span, trace_op, result, level);
+
   iter = gegl_buffer_iterator_new (output, result, 0, format,
                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
 
-  /* Get colors */
-  gfloat petal_color[4], center_color[4];
-  gegl_color_get_pixel (o->petal_color, format, petal_color);
-  gegl_color_get_pixel (o->center_color, format, center_color);
-
-  /* Flower pattern parameters */
-  gfloat period = o->flower_size + o->flower_spacing;
-  gfloat base_radius = o->flower_size * 0.5f;
-  gfloat center_radius = o->flower_size * 0.1f;
+  init_flower_pattern (o, format, &pattern);
 
   while (gegl_buffer_iterator_next (iter))
     {
       gfloat *out_data = iter->items[0].data;
       GeglRectangle roi = iter->items[0].roi;
-      gint x, y;
+      gint y;
 
       for (y = 0; y < roi.height; y++)
-        {
-          for (x = 0; x < roi.width; x++)
-            {
-              gint offset = (y * roi.width + x) * 4;
-              gfloat px = x + roi.x;
-              gfloat py = y + roi.y;
-
-              /* Initialize output to transparent */
-              gfloat color[4] = {0.0f, 0.0f, 0.0f, 0.0f}; /* FIXED: Transparent background */
-              gfloat alpha = 0.0f; /* Transparent by default */
-
-              /* Find the nearest flower center with staggered grid */
-              gfloat row_offset = (floorf (py / period) * 0.5f * period);
-              gfloat cx = floorf ((px - row_offset) / period) * period + period * 0.5f + row_offset;
-              gfloat cy = floorf (py / period) * period + period * 0.5f;
-
-              /* Compute distance to flower center */
-              gfloat dx = px - cx;
-              gfloat dy = py - cy;
-              gfloat dist = sqrtf (dx * dx + dy * dy);
-
-              /* Alternate between large and small flowers */
-              gfloat seed = noise (cx / period, cy / period);
-              gfloat row = floorf (py / period);
-              gfloat col = floorf ((px - row_offset) / period);
-              gfloat size_factor = (fmodf (row + col, 2.0f) < 1.0f) ? 1.0f : o->size_ratio;
-
-              gfloat petal_radius = base_radius * size_factor;
-              gfloat flower_center_radius = center_radius * size_factor;
-
-              /* Per-flower rotation */
-              gfloat flower_rotation = o->rotation_variation * (seed - 0.5f) * G_PI / 180.0f;
-              gfloat angle = atan2f (dy, dx) + flower_rotation;
-
-              /* Draw five petals with dynamic shape */
-              gfloat petal_angle = fmodf (angle, 2.0f * G_PI / 5.0f) - 2.0f * G_PI / 10.0f; /* Hardcode petal_count to 5 */
-              gfloat petal_width = petal_radius * 0.5f;
-
-              if (dist < petal_radius && fabsf (petal_angle) < G_PI / 5.0f && dist >= flower_center_radius)
-                {
-                  /* Petal shape with roundness controlled by petal_scale */
-                  gfloat t = dist / petal_radius;
-                  gfloat shape_factor = (o->petal_scale - 0.5f) / 1.5f; /* Use petal_scale */
-                  gfloat w = petal_width * (1.0f - powf(t, 2.0f + shape_factor * 2.0f)); /* Dynamic tapering */
-
-                  /* CHANGED: Simplified petal opacity for solid petals */
-                  gfloat angular_distance = fabsf (petal_angle) / (G_PI / 5.0f);
-                  gfloat edge_factor = angular_distance * petal_radius / w;
-                  gfloat petal_alpha = CLAMP(1.0f - edge_factor * 0.5f, 0.0f, 1.0f); /* Linear falloff for solid petals */
-
-                  for (gint j = 0; j < 3; j++)
-                    color[j] = petal_color[j] * petal_alpha; /* Premultiply RGB by alpha */
-                  alpha = petal_alpha; /* Solid red petals */
-                }
-
-              /* CHANGED: Draw the flower center with soft edges */
-              if (dist <= flower_center_radius)
-                {
-                  /* Soften edges with a gradual falloff */
-                  gfloat center_factor = dist / flower_center_radius;
-                  gfloat center_alpha = CLAMP(1.0f - center_factor * 0.5f, 0.0f, 1.0f); /* Linear falloff for soft edges */
-
-                  for (gint j = 0; j < 3; j++)
-                    color[j] = center_color[j] * center_alpha; /* Premultiply RGB by alpha */
-                  alpha = center_alpha; /* Soft-edged yellow centers */
-                }
-
-              /* FIXED: Write to output buffer with premultiplied alpha */
-              for (gint j = 0; j < 3; j++)
-                out_data[offset + j] = color[j]; /* Write premultiplied RGB */
-              out_data[offset + 3] = alpha; /* Write alpha */
-            }
-        }
+        render_flower_row (&pattern, roi.x, roi.y + y, roi.width,
+                           out_data + (gsize) y * roi.width * 4);
     }
 
+  grok_trace_end (&span, (guint64) result->width * result->height);
+
   return TRUE; /* FIXED: Single return statement at function end */
 }
 
@@ -226,6 +150,8 @@ gegl_op_class_init (GeglOpClass *klass)
     "gimp:menu-path", "<Image>/Filters/Grok/",
     "gimp:menu-label", _("Hawaiian Flowers Pattern"),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
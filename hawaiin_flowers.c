@@ -1,4 +1,4 @@
-/* hawaiian_flowers.c
+/* hawaiin_flowers.c
  *
  * Copyright (C) 2025 LinuxBeaver and contributors
  *
@@ -19,6 +19,7 @@
 #include "config.h"
 #include <glib/gi18n-lib.h>
 #include <math.h>
+#include "grok-noise.h"
 
 #ifdef GEGL_PROPERTIES
 
@@ -69,10 +70,11 @@ property_color (background_color, _("Background Color"), "#000000")
 #else
 
 #define GEGL_OP_FILTER
-#define GEGL_OP_NAME     grok
-#define GEGL_OP_C_SOURCE grok.c
+#define GEGL_OP_NAME     hawaiin_flowers
+#define GEGL_OP_C_SOURCE hawaiin_flowers.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
 
 static void
 prepare (GeglOperation *operation)
@@ -97,12 +99,7 @@ get_required_for_output (GeglOperation       *operation,
   return get_bounding_box (operation);
 }
 
-/* Simple noise function for texture */
-static gfloat
-noise (gfloat x, gfloat y)
-{
-  return sinf (x * 12.9898f + y * 78.233f) * 43758.5453f - floorf (sinf (x * 12.9898f + y * 78.233f) * 43758.5453f);
-}
+static GrokTraceOp *trace_op;
 
 static gboolean
 process (GeglOperation       *operation,
@@ -114,6 +111,8 @@ process (GeglOperation       *operation,
   GeglProperties *o = GEGL_PROPERTIES (operation);
   const Babl *format = babl_format ("RGBA float");
   GeglBufferIterator *iter;
+  GrokTraceSpan span;
+  gfloat *pollen_noise, *vein_noise;
 
   if (result->width < 1 || result->height < 1)
     {
@@ -122,6 +121,8 @@ process (GeglOperation       *operation,
       return TRUE;
     }
 
+  grok_trace_begin (&span, trace_op, result, level);
+
   iter = gegl_buffer_iterator_new (input, result, 0, format,
                                   GEGL_ACCESS_READ, GEGL_ABYSS_CLAMP, 2);
   gegl_buffer_iterator_add (iter, output, result, 0, format,
@@ -139,6 +140,11 @@ process (GeglOperation       *operation,
   gfloat center_radius = o->flower_size * 0.15f;
   gfloat stamen_length = o->flower_size * 0.4f;
 
+  /* The pollen and vein textures hash every pixel, a row at a time */
+  pollen_noise = g_new (gfloat, 2 * result->width);
+  vein_noise = pollen_noise + result->width;
+  grok_trace_scratch (&span, 2 * result->width * sizeof (gfloat));
+
   while (gegl_buffer_iterator_next (iter))
     {
       gfloat *in_data = iter->items[0].data;
@@ -147,107 +153,114 @@ process (GeglOperation       *operation,
       gint x, y;
 
       for (y = 0; y < roi.height; y++)
-        for (x = 0; x < roi.width; x++)
-          {
-            gint offset = (y * roi.width + x) * 4;
-            gfloat px = x + roi.x;
-            gfloat py = y + roi.y;
-
-            /* Default to background color */
-            gfloat *color = bg_color;
-            gfloat alpha = 1.0f;
-            gfloat lighting = 1.0f;
-
-            /* Find the nearest flower center with staggered grid */
-            gfloat row_offset = (floorf (py / period) * 0.5f * period);
-            gfloat cx = floorf ((px - row_offset) / period) * period + period * 0.5f + row_offset;
-            gfloat cy = floorf (py / period) * period + period * 0.5f;
-
-            /* Compute distance to flower center */
-            gfloat dx = px - cx;
-            gfloat dy = py - cy;
-            gfloat dist = sqrtf (dx * dx + dy * dy);
-
-            /* Per-flower variations */
-            gfloat seed = noise (cx / period, cy / period);
-            gfloat size_factor = 1.0f + o->size_variation * (seed - 0.5f);
-            gfloat petal_radius = base_radius * size_factor;
-            gfloat flower_rotation = o->rotation_variation * (seed - 0.5f) * G_PI / 180.0f;
-
-            /* Rotate coordinates relative to flower center */
-            gfloat angle = atan2f (dy, dx) + flower_rotation;
-            gfloat rdist = dist / petal_radius;
-
-            /* Draw the flower center */
-            if (dist < center_radius * size_factor)
-              {
-                color = center_color;
-                alpha = 1.0f;
-                gfloat gradient = 1.0f - dist / (center_radius * size_factor);
-                lighting = 1.0f + o->shading_intensity * gradient;
-                /* Add small pollen-like details */
-                gfloat noise_val = noise (px * 0.1f, py * 0.1f);
-                if (noise_val > 0.8f && dist > center_radius * 0.3f)
-                  lighting *= 1.2f;
-              }
-
-            /* Draw the stamen (thicker with anthers) */
-            gfloat stamen_angle = G_PI / 4.0f + flower_rotation;
-            gfloat stamen_dist = dist * cosf (angle - stamen_angle);
-            if (stamen_dist > center_radius && stamen_dist < stamen_length * size_factor &&
-                fabsf (dist * sinf (angle - stamen_angle)) < center_radius * 0.5f)
-              {
-                color = center_color;
-                alpha = 1.0f;
-                lighting = 1.0f - o->shading_intensity * (stamen_dist - center_radius) / (stamen_length - center_radius);
-                /* Add anther at the tip */
-                if (stamen_dist > stamen_length * 0.8f * size_factor)
-                  lighting *= 1.3f;
-              }
-
-            /* Draw five petals with irregular shapes */
-            gfloat petal_angle = fmodf (angle, 2.0f * G_PI / 5.0f) - 2.0f * G_PI / 10.0f;
-            gfloat petal_dist = dist * (1.0f + 0.3f * sinf (petal_angle * 5.0f)); /* Add curve to petal shape */
-            gfloat petal_width = petal_radius * 0.6f;
-
-            if (petal_dist < petal_radius && fabsf (petal_angle) < G_PI / 5.0f)
-              {
-                /* Elongated petal with pointed tip */
-                gfloat t = petal_dist / petal_radius;
-                gfloat w = petal_width * (1.0f - t * t) * o->petal_elongation;
-                gfloat petal_alpha = CLAMP (1.0f - fabsf (petal_angle) / (G_PI / 5.0f) * petal_radius / w, 0.0f, 1.0f);
-
-                if (petal_alpha > 0.0f)
-                  {
-                    color = petal_color;
-                    alpha = petal_alpha;
-
-                    /* Color gradient: darker at base, lighter at tip */
-                    gfloat gradient = 1.0f - t;
-                    lighting = 1.0f + o->shading_intensity * gradient;
-
-                    /* Add vein-like texture */
-                    gfloat vein_noise = noise (px * 0.05f, py * 0.05f);
-                    lighting += 0.1f * vein_noise * gradient;
-                  }
-              }
-
-            /* Apply color and blend */
-            gfloat final_color[4];
-            for (gint j = 0; j < 3; j++)
-              final_color[j] = CLAMP (color[j] * lighting, 0.0f, 1.0f);
-            final_color[3] = alpha;
-
-            for (gint j = 0; j < 4; j++)
-              {
-                out_data[offset + j] = (1.0f - o->opacity * alpha) * in_data[offset + j] +
-                                       (o->opacity * alpha) * final_color[j];
-                if (j == 3)
-                  out_data[offset + j] = 1.0f; /* Fully opaque output */
-              }
-          }
+        {
+          grok_noise2_row (roi.x, y + roi.y, 1, pollen_noise, roi.width);
+          grok_noise2_row (roi.x, y + roi.y, 2, vein_noise, roi.width);
+
+          for (x = 0; x < roi.width; x++)
+            {
+              gint offset = (y * roi.width + x) * 4;
+              gfloat px = x + roi.x;
+              gfloat py = y + roi.y;
+
+              /* Default to background color */
+              gfloat *color = bg_color;
+              gfloat alpha = 1.0f;
+              gfloat lighting = 1.0f;
+
+              /* Find the nearest flower center with staggered grid */
+              gfloat row_offset = (floorf (py / period) * 0.5f * period);
+              gfloat cx = floorf ((px - row_offset) / period) * period + period * 0.5f + row_offset;
+              gfloat cy = floorf (py / period) * period + period * 0.5f;
+
+              /* Compute distance to flower center */
+              gfloat dx = px - cx;
+              gfloat dy = py - cy;
+              gfloat dist = sqrtf (dx * dx + dy * dy);
+
+              /* Per-flower variations, hashed from the flower's grid cell */
+              gfloat seed = grok_noise2 ((gint) floorf ((px - row_offset) / period),
+                                         (gint) floorf (py / period), 0);
+              gfloat size_factor = 1.0f + o->size_variation * (seed - 0.5f);
+              gfloat petal_radius = base_radius * size_factor;
+              gfloat flower_rotation = o->rotation_variation * (seed - 0.5f) * G_PI / 180.0f;
+
+              /* Rotate coordinates relative to flower center */
+              gfloat angle = atan2f (dy, dx) + flower_rotation;
+              gfloat rdist = dist / petal_radius;
+
+              /* Draw the flower center */
+              if (dist < center_radius * size_factor)
+                {
+                  color = center_color;
+                  alpha = 1.0f;
+                  gfloat gradient = 1.0f - dist / (center_radius * size_factor);
+                  lighting = 1.0f + o->shading_intensity * gradient;
+                  /* Add small pollen-like details */
+                  if (pollen_noise[x] > 0.8f && dist > center_radius * 0.3f)
+                    lighting *= 1.2f;
+                }
+
+              /* Draw the stamen (thicker with anthers) */
+              gfloat stamen_angle = G_PI / 4.0f + flower_rotation;
+              gfloat stamen_dist = dist * cosf (angle - stamen_angle);
+              if (stamen_dist > center_radius && stamen_dist < stamen_length * size_factor &&
+                  fabsf (dist * sinf (angle - stamen_angle)) < center_radius * 0.5f)
+                {
+                  color = center_color;
+                  alpha = 1.0f;
+                  lighting = 1.0f - o->shading_intensity * (stamen_dist - center_radius) / (stamen_length - center_radius);
+                  /* Add anther at the tip */
+                  if (stamen_dist > stamen_length * 0.8f * size_factor)
+                    lighting *= 1.3f;
+                }
+
+              /* Draw five petals with irregular shapes */
+              gfloat petal_angle = fmodf (angle, 2.0f * G_PI / 5.0f) - 2.0f * G_PI / 10.0f;
+              gfloat petal_dist = dist * (1.0f + 0.3f * sinf (petal_angle * 5.0f)); /* Add curve to petal shape */
+              gfloat petal_width = petal_radius * 0.6f;
+
+              if (petal_dist < petal_radius && fabsf (petal_angle) < G_PI / 5.0f)
+                {
+                  /* Elongated petal with pointed tip */
+                  gfloat t = petal_dist / petal_radius;
+                  gfloat w = petal_width * (1.0f - t * t) * o->petal_elongation;
+                  gfloat petal_alpha = CLAMP (1.0f - fabsf (petal_angle) / (G_PI / 5.0f) * petal_radius / w, 0.0f, 1.0f);
+
+                  if (petal_alpha > 0.0f)
+                    {
+                      color = petal_color;
+                      alpha = petal_alpha;
+
+                      /* Color gradient: darker at base, lighter at tip */
+                      gfloat gradient = 1.0f - t;
+                      lighting = 1.0f + o->shading_intensity * gradient;
+
+                      /* Add vein-like texture */
+                      lighting += 0.1f * vein_noise[x] * gradient;
+                    }
+                }
+
+              /* Apply color and blend */
+              gfloat final_color[4];
+              for (gint j = 0; j < 3; j++)
+                final_color[j] = CLAMP (color[j] * lighting, 0.0f, 1.0f);
+              final_color[3] = alpha;
+
+              for (gint j = 0; j < 4; j++)
+                {
+                  out_data[offset + j] = (1.0f - o->opacity * alpha) * in_data[offset + j] +
+                                         (o->opacity * alpha) * final_color[j];
+                  if (j == 3)
+                    out_data[offset + j] = 1.0f; /* Fully opaque output */
+                }
+            }
+        }
     }
 
+  g_free (pollen_noise);
+  grok_trace_end (&span, (guint64) result->width * result->height);
+
   return TRUE;
 }
 
@@ -263,13 +276,15 @@ gegl_op_class_init (GeglOpClass *klass)
   filter_class->process            = process;
 
   gegl_operation_class_set_keys (operation_class,
-    "name",        "gegl:hawaiian_flowers",
+    "name",        "grok:shaded-flowers",
     "title",       _("Hawaiian Flowers Pattern"),
     "categories",  "render:pattern",
     "description", _("Renders a natural pattern of Hawaiian flowers, such as hibiscus, with organic shapes and textures"),
     "gimp:menu-path", "<Image>/Filters/Render/Pattern",
     "gimp:menu-label", _("Hawaiian Flowers Pattern"),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
@@ -19,7 +19,6 @@
 #include "config.h"
 #include <glib/gi18n-lib.h>
 #include <math.h>
-#include <gegl.h> /* CHANGED: Include GEGL for node processing */
 
 #ifdef GEGL_PROPERTIES
 
@@ -57,10 +56,12 @@ property_color (center_color, _("Center Color"), "#ffff00")
 #else
 
 #define GEGL_OP_FILTER
-#define GEGL_OP_NAME     hawaiian
-#define GEGL_OP_C_SOURCE hawaiian.c
+#define GEGL_OP_NAME     hawaiian_solid
+#define GEGL_OP_C_SOURCE hawaiin_flowers/hawaiian.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
+#include "grok-flowers.h"
 
 static void
 prepare (GeglOperation *operation)
@@ -85,12 +86,7 @@ get_required_for_output (GeglOperation       *operation,
   return get_bounding_box (operation);
 }
 
-/* Simple noise function for random variation */
-static gfloat
-noise (gfloat x, gfloat y)
-{
-  return sinf (x * 12.9898f + y * 78.233f) * 43758.5453f - floorf (sinf (x * 12.9898f + y * 78.233f) * 43758.5453f);
-}
+static GrokTraceOp *trace_op;
 
 static gboolean
 process (GeglOperation       *operation,
@@ -101,8 +97,9 @@ process (GeglOperation       *operation,
 {
   GeglProperties *o = GEGL_PROPERTIES (operation);
   const Babl *format = babl_format ("RGBA float");
-  GeglBuffer *temp_buffer = NULL;
   GeglBufferIterator *iter;
+  GrokTraceSpan span;
+  FlowerPattern pattern;
 
   if (result->width < 1 || result->height < 1)
     {
@@ -111,132 +108,25 @@ process (GeglOperation       *operation,
       return TRUE;
     }
 
-  /* CHANGED: Create temporary buffer for flower pattern */
-  temp_buffer = gegl_buffer_new (result, format);
-  iter = gegl_buffer_iterator_new (temp_buffer, result, 0, format,
-                                  GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+  grok_trace_begin (&span, trace_op, result, level);
 
-  /* Get colors */
-  gfloat petal_color[4], center_color[4];
-  gegl_color_get_pixel (o->petal_color, format, petal_color);
-  gegl_color_get_pixel (o->center_color, format, center_color);
+  iter = gegl_buffer_iterator_new (output, result, 0, format,
+                                  GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
 
-  /* Flower pattern parameters */
-  gfloat period = o->flower_size + o->flower_spacing;
-  gfloat base_radius = o->flower_size * 0.5f;
-  gfloat center_radius = o->flower_size * 0.1f;
+  init_flower_pattern (o, format, &pattern);
 
-  /* Render flower pattern to temporary buffer */
   while (gegl_buffer_iterator_next (iter))
     {
       gfloat *out_data = iter->items[0].data;
       GeglRectangle roi = iter->items[0].roi;
-      gint x, y;
+      gint y;
 
       for (y = 0; y < roi.height; y++)
-        {
-          for (x = 0; x < roi.width; x++)
-            {
-              gint offset = (y * roi.width + x) * 4;
-              gfloat px = x + roi.x;
-              gfloat py = y + roi.y;
-
-              /* Initialize output to transparent */
-              gfloat color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-              gfloat alpha = 0.0f;
-
-              /* Find the nearest flower center with staggered grid */
-              gfloat row_offset = (floorf (py / period) * 0.5f * period);
-              gfloat cx = floorf ((px - row_offset) / period) * period + period * 0.5f + row_offset;
-              gfloat cy = floorf (py / period) * period + period * 0.5f;
-
-              /* Compute distance to flower center */
-              gfloat dx = px - cx;
-              gfloat dy = py - cy;
-              gfloat dist = sqrtf (dx * dx + dy * dy);
-
-              /* Alternate between large and small flowers */
-              gfloat seed = noise (cx / period, cy / period);
-              gfloat row = floorf (py / period);
-              gfloat col = floorf ((px - row_offset) / period);
-              gfloat size_factor = (fmodf (row + col, 2.0f) < 1.0f) ? 1.0f : o->size_ratio;
-
-              gfloat petal_radius = base_radius * size_factor;
-              gfloat flower_center_radius = center_radius * size_factor;
-
-              /* Per-flower rotation */
-              gfloat flower_rotation = o->rotation_variation * (seed - 0.5f) * G_PI / 180.0f;
-              gfloat angle = atan2f (dy, dx) + flower_rotation;
-
-              /* Draw five petals with dynamic shape */
-              gfloat petal_angle = fmodf (angle, 2.0f * G_PI / 5.0f) - 2.0f * G_PI / 10.0f;
-              gfloat petal_width = petal_radius * 0.5f;
-
-              if (dist < petal_radius && fabsf (petal_angle) < G_PI / 5.0f && dist >= flower_center_radius)
-                {
-                  /* Petal shape with roundness controlled by petal_scale */
-                  gfloat t = dist / petal_radius;
-                  gfloat shape_factor = (o->petal_scale - 0.5f) / 1.5f;
-                  gfloat w = petal_width * (1.0f - powf(t, 2.0f + shape_factor * 2.0f));
-
-                  /* Linear falloff for petals */
-                  gfloat angular_distance = fabsf (petal_angle) / (G_PI / 5.0f);
-                  gfloat edge_factor = angular_distance * petal_radius / w;
-                  gfloat petal_alpha = CLAMP(1.0f - edge_factor * 0.5f, 0.0f, 1.0f);
-
-                  for (gint j = 0; j < 3; j++)
-                    color[j] = petal_color[j] * petal_alpha;
-                  alpha = petal_alpha;
-                }
-
-              /* Draw the flower center */
-              if (dist <= flower_center_radius)
-                {
-                  gfloat center_factor = dist / flower_center_radius;
-                  gfloat center_alpha = CLAMP(1.0f - center_factor * 0.5f, 0.0f, 1.0f);
-
-                  for (gint j = 0; j < 3; j++)
-                    color[j] = center_color[j] * center_alpha;
-                  alpha = center_alpha;
-                }
-
-              /* Write to temporary buffer */
-              for (gint j = 0; j < 3; j++)
-                out_data[offset + j] = color[j];
-              out_data[offset + 3] = alpha;
-            }
-        }
+        render_flower_row (&pattern, roi.x, roi.y + y, roi.width,
+                           out_data + (gsize) y * roi.width * 4);
     }
 
-  /* CHANGED: Save temp_buffer to verify flower pattern */
-  gegl_buffer_save (temp_buffer, "flowers_temp.png", NULL);
-
-  /* CHANGED: Create GEGL node graph with single gegl:gegl node */
-  GeglNode *graph = gegl_node_new();
-  GeglNode *output_proxy = gegl_node_get_output_proxy (graph, "output");
-
-  GeglNode *buffer_source = gegl_node_new_child (graph,
-                                                "operation", "gegl:buffer-source",
-                                                "buffer", temp_buffer,
-                                                NULL);
-#define aftergraph \
-" id=1 ref=1 gegl:opacity value=3 lb:threshold-alpha median-blur radius=0 abyss-policy=none  "\
-
-
-  GeglNode *gegl_node = gegl_node_new_child (graph,
-                                             "operation", "gegl:gegl", "string", aftergraph,
-                       
-                                             NULL);
-
-  /* CHANGED: Connect nodes: buffer-source -> gegl:gegl -> output_proxy */
-  gegl_node_link_many (buffer_source, gegl_node, output_proxy, NULL);
-
-  /* CHANGED: Process the node graph */
-  gegl_node_process (output_proxy);
-
-  /* Clean up */
-  g_object_unref (temp_buffer);
-  g_object_unref (graph);
+  grok_trace_end (&span, (guint64) result->width * result->height);
 
   return TRUE;
 }
@@ -253,13 +143,16 @@ gegl_op_class_init (GeglOpClass *klass)
   filter_class->process            = process;
 
   gegl_operation_class_set_keys (operation_class,
-    "name",        "gegl:hawaiian-flowers",
+    "name",        "grok:hawaiian-flowers-solid",
+    "compat-name", "gegl:hawaiian-flowers",
     "title",       _("Hawaiian Flowers Pattern"),
     "categories",  "render:pattern",
     "description", _("Renders a stylized Hawaiian flower pattern with teardrop-shaped petals in a staggered grid, against a transparent background"),
     "gimp:menu-path", "<Image>/Filters/Render/Pattern/",
     "gimp:menu-label", _("Hawaiian Flowers Pattern"),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
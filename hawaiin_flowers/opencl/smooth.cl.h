@@ -0,0 +1,82 @@
+static const char* smooth_cl_source =
+"#define MIN_WEIGHT_SUM 1e-6f                                                  \n"
+"                                                                              \n"
+"float conductance (float gradient, float kappa)                               \n"
+"{                                                                             \n"
+"  float g = gradient / kappa;                                                 \n"
+"  return exp (-g * g);                                                        \n"
+"}                                                                             \n"
+"                                                                              \n"
+"/* One explicit step over the pixels at least margin away from the texture    \n"
+" * edge; src and dst share the stride.  Neighbours outside valid (x0, y0,     \n"
+" * x1, y1 with exclusive ends) are missing, like at the image border on       \n"
+" * the CPU path.                                                              \n"
+" */                                                                           \n"
+"__kernel void smooth_cl (__global const float4 *src_buf,                      \n"
+"                         __global       float4 *dst_buf,                      \n"
+"                         int                    stride,                       \n"
+"                         int                    margin,                       \n"
+"                         int4                   valid,                        \n"
+"                         float                  kappa,                        \n"
+"                         float                  alpha_strength,               \n"
+"                         float                  delta_t)                      \n"
+"{                                                                             \n"
+"  int    x      = get_global_id(0) + margin;                                  \n"
+"  int    y      = get_global_id(1) + margin;                                  \n"
+"  int    offset = y * stride + x;                                             \n"
+"  float4 center = src_buf[offset];                                            \n"
+"  float4 grad_w = (float4)(0.0f);                                             \n"
+"  float4 grad_e = (float4)(0.0f);                                             \n"
+"  float4 grad_n = (float4)(0.0f);                                             \n"
+"  float4 grad_s = (float4)(0.0f);                                             \n"
+"  float  w_w = 0.0f, w_e = 0.0f, w_n = 0.0f, w_s = 0.0f;                      \n"
+"  float  weight_sum;                                                          \n"
+"  float4 sum = (float4)(0.0f);                                                \n"
+"                                                                              \n"
+"  if (x < valid.x || y < valid.y || x >= valid.z || y >= valid.w)             \n"
+"    {                                                                         \n"
+"      dst_buf[offset] = center;                                               \n"
+"      return;                                                                 \n"
+"    }                                                                         \n"
+"                                                                              \n"
+"  if (x > valid.x)                                                            \n"
+"    {                                                                         \n"
+"      grad_w = src_buf[offset - 1] - center;                                  \n"
+"      w_w = conductance (fabs (grad_w.x), kappa);                             \n"
+"    }                                                                         \n"
+"  if (x < valid.z - 1)                                                        \n"
+"    {                                                                         \n"
+"      grad_e = src_buf[offset + 1] - center;                                  \n"
+"      w_e = conductance (fabs (grad_e.x), kappa);                             \n"
+"    }                                                                         \n"
+"  if (y > valid.y)                                                            \n"
+"    {                                                                         \n"
+"      grad_n = src_buf[offset - stride] - center;                             \n"
+"      w_n = conductance (fabs (grad_n.x), kappa);                             \n"
+"    }                                                                         \n"
+"  if (y < valid.w - 1)                                                        \n"
+"    {                                                                         \n"
+"      grad_s = src_buf[offset + stride] - center;                             \n"
+"      w_s = conductance (fabs (grad_s.x), kappa);                             \n"
+"    }                                                                         \n"
+"                                                                              \n"
+"  weight_sum = w_w + w_e + w_n + w_s;                                         \n"
+"  if (weight_sum > MIN_WEIGHT_SUM)                                            \n"
+"    sum = clamp ((alpha_strength / weight_sum) *                              \n"
+"                 (w_w * grad_w + w_e * grad_e + w_n * grad_n + w_s * grad_s), \n"
+"                 -2.0f, 2.0f);                                                \n"
+"                                                                              \n"
+"  dst_buf[offset] = clamp (center + delta_t * sum, 0.0f, 1.0f);               \n"
+"}                                                                             \n"
+"                                                                              \n"
+"__kernel void transfer(__global float4 * in,                                  \n"
+"              int               in_width,                                     \n"
+"              int               in_offset,                                    \n"
+"              __global float4 * out)                                          \n"
+"{                                                                             \n"
+"    int gidx = get_global_id(0);                                              \n"
+"    int gidy = get_global_id(1);                                              \n"
+"    int width = get_global_size(0);                                           \n"
+"    out[gidy * width + gidx] = in[in_offset + gidy * in_width + gidx];        \n"
+"}                                                                             \n"
+;
@@ -102,6 +102,9 @@ property_double (line_spacing, _("Default Line Spacing"), 1.15)
     ui_meta ("maximum", "3.0")
     ui_meta ("step", "0.05")
 
+property_boolean (float_render, _("Float Rendering"), FALSE)
+    description (_("Rasterize straight into the float output tiles instead of an 8-bit cairo surface, avoiding banding on soft edges. Ignored for CMYK colors or when cairo lacks float surfaces."))
+
 #else
 
 #include <gegl-plugin.h>
@@ -109,6 +112,12 @@ property_double (line_spacing, _("Default Line Spacing"), 1.15)
 #include <pango/pango-attributes.h>
 #include <pango/pangocairo.h>
 #include <math.h>
+#include <string.h>
+
+/* cairo 1.17.2 added premultiplied float image surfaces */
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE (1, 17, 2)
+#define HAVE_CAIRO_FLOAT 1
+#endif
 
 struct _GeglOp
 {
@@ -126,8 +135,25 @@ typedef struct
 #define GEGL_OP_C_SOURCE pango-markup.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
 GEGL_DEFINE_DYNAMIC_OPERATION (GEGL_TYPE_OPERATION_SOURCE)
 
+/* Shaped layouts are cached per component set (RGB, cyk, cmk) and keyed
+ * on everything that changes shaping or the default colour; rotation and
+ * vertical placement only move the layout and are applied when drawing.
+ */
+typedef struct {
+  PangoLayout   *layout;
+  gchar         *text;
+  gchar         *font;
+  gdouble        font_size;
+  gdouble        letter_spacing;
+  gint           wrap;
+  gint           alignment;
+  gdouble        line_spacing;
+  guint16        color[4];
+} PM_Layout;
+
 typedef struct {
   gchar         *text;
   gchar         *font;
@@ -143,39 +169,83 @@ typedef struct {
 
   GeglOperationSource parent_instance;
   gpointer            properties;
+
+  /* Pango objects are not thread-safe, so the layouts live on a private
+   * font map and every use of them holds the mutex.
+   */
+  GMutex         mutex;
+  PangoFontMap  *font_map;
+  PangoContext  *context;
+  PM_Layout      layouts[3];
 } PM_UserData;
 
+static PM_UserData *
+markup_user_data (GeglProperties *o)
+{
+  PM_UserData *userData = o->user_data;
+
+  if (!userData) {
+    o->user_data = userData = g_malloc0 (sizeof (PM_UserData));
+    g_mutex_init (&userData->mutex);
+  }
+  return userData;
+}
+
 static void
-markup_layout_text (GeglOp        *self,
-                    cairo_t       *cr,
-                    gdouble        rowstride,
-                    GeglRectangle *bounds,
-                    int            component_set)
+markup_text_color (GeglProperties *o,
+                   int             component_set,
+                   guint16        *color)
 {
-  GeglProperties       *o = GEGL_PROPERTIES (self);
+  switch (component_set)
+  {
+    case 0:
+      gegl_color_get_pixel (o->color, babl_format ("R'G'B'A u16"), color);
+      break;
+    case 1:
+      gegl_color_get_pixel (o->color, babl_format ("cykA u16"), color);
+      break;
+    case 2:
+      gegl_color_get_pixel (o->color, babl_format ("cmkA u16"), color);
+      break;
+  }
+}
+
+/* Returns the shaped layout for the current properties, reshaping only
+ * when the cache key changed.  Called with the mutex held.
+ */
+static PangoLayout *
+markup_get_layout (GeglProperties *o,
+                   PM_UserData    *userData,
+                   int             component_set,
+                   guint16        *color)
+{
+  PM_Layout            *cached = &userData->layouts[component_set];
   PangoLayout          *layout;
   PangoAttrList        *attrs;
   PangoFontDescription *desc;
-  guint16               color[4];
   gchar                *text;
   gint                  alignment = 0;
-  PangoRectangle        ink_rect;
-  PangoRectangle        logical_rect;
-  gint                  vertical_offset = 0;
 
-  layout = pango_cairo_create_layout (cr);
-  PM_UserData *userData = o->user_data;
-  if (!userData) {
-    o->user_data = userData = g_malloc0 (sizeof (PM_UserData));
-    userData->text = 0;
-    userData->font = 0;
-    userData->font_size = 0.0;
-    userData->letter_spacing = 0.0;
-    userData->rotation = 0.0; /* Initialize rotation cache */
-  }
-  if (!o->text) {
-    return;
+  markup_text_color (o, component_set, color);
+
+  if (cached->layout &&
+      !g_strcmp0 (cached->text, o->text) &&
+      !g_strcmp0 (cached->font, o->font) &&
+      cached->font_size == o->font_size &&
+      cached->letter_spacing == o->letter_spacing &&
+      cached->wrap == o->wrap &&
+      cached->alignment == o->alignment &&
+      cached->line_spacing == o->line_spacing &&
+      !memcmp (cached->color, color, sizeof (cached->color)))
+    return cached->layout;
+
+  if (!userData->context) {
+    userData->font_map = pango_cairo_font_map_new ();
+    userData->context = pango_font_map_create_context (userData->font_map);
   }
+  if (!cached->layout)
+    cached->layout = pango_layout_new (userData->context);
+  layout = cached->layout;
 
   /* Set up font */
   desc = pango_font_description_new();
@@ -211,19 +281,6 @@ markup_layout_text (GeglOp        *self,
     pango_attr_list_insert(attrs, spacing);
   }
 
-  switch (component_set)
-  {
-    case 0:
-      gegl_color_get_pixel (o->color, babl_format ("R'G'B'A u16"), color);
-      break;
-    case 1:
-      gegl_color_get_pixel (o->color, babl_format ("cykA u16"), color);
-      break;
-    case 2:
-      gegl_color_get_pixel (o->color, babl_format ("cmkA u16"), color);
-      break;
-  }
-
   pango_attr_list_insert (
     attrs,
     pango_attr_foreground_new (color[0], color[1], color[2]));
@@ -233,7 +290,77 @@ markup_layout_text (GeglOp        *self,
 
   pango_layout_set_attributes (layout, attrs);
 
-  pango_cairo_update_layout (cr, layout);
+  pango_font_description_free(desc);
+  pango_attr_list_unref (attrs);
+
+  g_free (cached->text);
+  g_free (cached->font);
+  cached->text = g_strdup (o->text);
+  cached->font = g_strdup (o->font);
+  cached->font_size = o->font_size;
+  cached->letter_spacing = o->letter_spacing;
+  cached->wrap = o->wrap;
+  cached->alignment = o->alignment;
+  cached->line_spacing = o->line_spacing;
+  memcpy (cached->color, color, sizeof (cached->color));
+
+  return layout;
+}
+
+/* Draws only the lines whose ink reaches the clip, which for a tile is
+ * its ROI; the rest of the layout is never rasterized.
+ */
+static void
+markup_show_visible_lines (cairo_t     *cr,
+                           PangoLayout *layout)
+{
+  PangoLayoutIter *iter;
+  gdouble          x1, y1, x2, y2;
+
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+
+  iter = pango_layout_get_iter (layout);
+  do
+    {
+      PangoRectangle ink_rect;
+      PangoRectangle logical_rect;
+
+      pango_layout_iter_get_line_extents (iter, &ink_rect, &logical_rect);
+      pango_extents_to_pixels (&ink_rect, NULL);
+
+      if (ink_rect.x < x2 && ink_rect.x + ink_rect.width > x1 &&
+          ink_rect.y < y2 && ink_rect.y + ink_rect.height > y1)
+        {
+          cairo_move_to (cr, (gdouble) logical_rect.x / PANGO_SCALE,
+                         (gdouble) pango_layout_iter_get_baseline (iter) / PANGO_SCALE);
+          pango_cairo_show_layout_line (cr, pango_layout_iter_get_line_readonly (iter));
+        }
+    }
+  while (pango_layout_iter_next_line (iter));
+  pango_layout_iter_free (iter);
+}
+
+static void
+markup_layout_text (GeglOp        *self,
+                    cairo_t       *cr,
+                    gdouble        rowstride,
+                    GeglRectangle *bounds,
+                    int            component_set)
+{
+  GeglProperties       *o = GEGL_PROPERTIES (self);
+  PM_UserData          *userData = markup_user_data (o);
+  PangoLayout          *layout;
+  guint16               color[4];
+  PangoRectangle        ink_rect;
+  PangoRectangle        logical_rect;
+  gint                  vertical_offset = 0;
+
+  if (!o->text) {
+    return;
+  }
+
+  g_mutex_lock (&userData->mutex);
+  layout = markup_get_layout (o, userData, component_set, color);
 
   pango_layout_get_pixel_extents (layout, &ink_rect, &logical_rect);
 
@@ -285,7 +412,7 @@ markup_layout_text (GeglOp        *self,
       if (color[3] > 0)
         {
           cairo_translate(cr, 0, vertical_offset);
-          pango_cairo_show_layout (cr, layout);
+          markup_show_visible_lines (cr, layout);
         }
     }
 
@@ -293,11 +420,11 @@ markup_layout_text (GeglOp        *self,
     cairo_restore(cr); /* Restore Cairo context after rotation */
   }
 
-  pango_font_description_free(desc);
-  pango_attr_list_unref (attrs);
-  g_object_unref (layout);
+  g_mutex_unlock (&userData->mutex);
 }
 
+static GrokTraceOp *trace_op;
+
 static gboolean
 process (GeglOperation       *operation,
          GeglBuffer          *output,
@@ -311,6 +438,42 @@ process (GeglOperation       *operation,
 
   cairo_t         *cr;
   cairo_surface_t *surface;
+  guchar          *data;
+  GrokTraceSpan    span;
+
+  grok_trace_begin (&span, trace_op, result, level);
+
+#ifdef HAVE_CAIRO_FLOAT
+  if (format == babl_format ("R'aG'aB'aA float"))
+  {
+    /* Float rendering: cairo draws directly into the output tiles */
+    GeglBufferIterator *iter;
+
+    iter = gegl_buffer_iterator_new (output, result, 0, format,
+                                     GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+
+    while (gegl_buffer_iterator_next (iter))
+    {
+      const GeglRectangle *roi = &iter->items[0].roi;
+
+      memset (iter->items[0].data, 0, roi->width * roi->height * 16);
+
+      surface = cairo_image_surface_create_for_data (iter->items[0].data,
+                                                     CAIRO_FORMAT_RGBA128F,
+                                                     roi->width,
+                                                     roi->height,
+                                                     roi->width * 16);
+      cr = cairo_create (surface);
+      cairo_translate (cr, -roi->x, -roi->y);
+      markup_layout_text (self, cr, 0, NULL, 0);
+      cairo_destroy (cr);
+      cairo_surface_destroy (surface);
+    }
+    grok_trace_end (&span, (guint64) result->width * result->height);
+    return TRUE;
+  }
+#endif
+
   if (is_cmyk)
   {
     formats[0]=babl_format ("cairo-ACYK32");
@@ -321,10 +484,15 @@ process (GeglOperation       *operation,
     formats[0]=babl_format ("cairo-ARGB32");
   }
 
+  /* The surface covers only the requested tile, so cairo clips every
+   * pass to it; one scratch buffer is shared by the CMYK passes.
+   */
+  data = g_new (guchar, result->width * result->height * 4);
+  grok_trace_scratch (&span, (gsize) result->width * result->height * 4);
+
   for (int i = 0; formats[i]; i++)
   {
-    guchar *data;
-    data  = g_new0 (guchar, result->width * result->height * 4);
+    memset (data, 0, result->width * result->height * 4);
 
     surface = cairo_image_surface_create_for_data (data,
                                                  CAIRO_FORMAT_ARGB32,
@@ -340,8 +508,10 @@ process (GeglOperation       *operation,
 
     cairo_destroy (cr);
     cairo_surface_destroy (surface);
-    g_free (data);
   }
+  g_free (data);
+
+  grok_trace_end (&span, (guint64) result->width * result->height);
 
   return TRUE;
 }
@@ -351,18 +521,9 @@ get_bounding_box (GeglOperation *operation)
 {
   GeglOp *self = GEGL_OP (operation);
   GeglProperties *o = GEGL_PROPERTIES (self);
-  PM_UserData *userData = o->user_data;
+  PM_UserData *userData = markup_user_data (o);
   gint status = FALSE;
 
-  if (!userData) {
-    o->user_data = userData = g_malloc0 (sizeof (PM_UserData));
-    userData->text = 0;
-    userData->font = 0;
-    userData->font_size = 0.0;
-    userData->letter_spacing = 0.0;
-    userData->rotation = 0.0;
-  }
-
   if ((userData->text && strcmp (userData->text, o->text)) ||
       (userData->font && strcmp (userData->font, o->font)) ||
       userData->font_size != o->font_size ||
@@ -428,6 +589,15 @@ finalize (GObject *object)
         {
           g_free (userData->font);
         }
+      for (gint i = 0; i < G_N_ELEMENTS (userData->layouts); i++)
+        {
+          g_clear_object (&userData->layouts[i].layout);
+          g_free (userData->layouts[i].text);
+          g_free (userData->layouts[i].font);
+        }
+      g_clear_object (&userData->context);
+      g_clear_object (&userData->font_map);
+      g_mutex_clear (&userData->mutex);
       g_free (userData);
       o->user_data = NULL;
     }
@@ -440,26 +610,26 @@ prepare (GeglOperation *operation)
   GeglProperties *o = GEGL_PROPERTIES (operation);
   const Babl *color_format = gegl_color_get_format (o->color);
   BablModelFlag model_flags = babl_get_model_flags (color_format);
-  PM_UserData *userData = o->user_data;
 
   if (model_flags & BABL_MODEL_FLAG_CMYK)
   {
     gegl_operation_set_format (operation, "output",
                                babl_format ("camayakaA u8"));
   }
+#ifdef HAVE_CAIRO_FLOAT
+  else if (o->float_render)
+  {
+    /* Matches CAIRO_FORMAT_RGBA128F, so tiles need no conversion */
+    gegl_operation_set_format (operation, "output",
+                               babl_format ("R'aG'aB'aA float"));
+  }
+#endif
   else
   {
     gegl_operation_set_format (operation, "output",
                                babl_format ("RaGaBaA float"));
   }
-  if (!userData) {
-    o->user_data = userData = g_malloc0 (sizeof (PM_UserData));
-    userData->text = 0;
-    userData->font = 0;
-    userData->font_size = 0.0;
-    userData->letter_spacing = 0.0;
-    userData->rotation = 0.0;
-  }
+  markup_user_data (o);
 }
 
 static const gchar *composition =
@@ -499,6 +669,8 @@ gegl_op_class_init (GeglOpClass *klass)
     "reference-hash", "deafbededeafbededeafbededeafbede",
     "description",  _("Display a string containing XML-style marked-up text using Pango and Cairo, with customizable font, size, spacing, letter spacing, rotation, and color."),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
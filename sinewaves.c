@@ -22,6 +22,7 @@
 #include <gegl.h>
 #include <gegl-plugin.h>
 #include <math.h>
+#include <string.h>
 
 #ifdef GEGL_PROPERTIES
 
@@ -110,6 +111,12 @@ property_double(rotation, _("Rotation"), 0.0)
     value_range(0.0, 360.0)
     ui_range(0.0, 360.0)
 
+property_boolean(antialias, _("Antialias"), TRUE)
+    description(_("Smooth the pattern edges using the distance to each edge; off gives the hard edged look"))
+
+property_boolean(tile_cache, _("Cache Tile"), FALSE)
+    description(_("Rasterize one tile period once and fill the output from it; repeated renders with the same pattern, tile size and line width become lookups, rotated patterns snap to the tile's pixel grid"))
+
 property_color(foreground_color, _("Foreground Color"), "#5BA9EA")
     description(_("Color of the pattern shapes"))
 
@@ -118,35 +125,1858 @@ property_color(background_color, _("Background Color"), "#70D0FF")
 
 #else
 
-#define GEGL_OP_POINT_FILTER
+#define GEGL_OP_POINT_RENDER
 #define GEGL_OP_NAME     sinewaves
 #define GEGL_OP_C_SOURCE sinewaves.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
+
+static GeglRectangle get_bounding_box (GeglOperation *operation)
+{
+  return gegl_rectangle_infinite_plane ();
+}
+
+/* Pattern library.  Every pattern is a signed field in tile space, negative
+ * inside the shape: a < b becomes a - b, a <= b becomes -(b - a) so that
+ * equality gives -0.0, || the minimum and && the maximum of the parts.
+ * tx and ty are the rotated coordinates wrapped to [0, tile_size),
+ * width_scale is the line_width property.  SW_FAR stands for conditions
+ * that are not distances, like which half of a checker a pixel is in.
+ */
+#define SW_FAR 1e9
+
+static inline gdouble
+pattern_lattice_1 (gdouble tx,
+                   gdouble ty,
+                   gdouble tile_size,
+                   gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+
+  field = fmin (field, fmin (fmin (fmin (cx - line_width,
+                                         cell_size - line_width - cx),
+                                   cy - line_width),
+                             cell_size - line_width - cy));
+  field = fmin (field, fmin (fabs(cx - cy) - line_width,
+                             fabs(cx + cy - cell_size) - line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_ripple_effect (gdouble tx,
+                       gdouble ty,
+                       gdouble tile_size,
+                       gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble ripple_spacing = cell_size / 8.0;
+  gdouble ripple_dist = fmod(dist, ripple_spacing);
+  gdouble base_line_width = ripple_spacing * 0.2;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, ripple_dist - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_petal_swirls (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble petal_angle = fmod(angle * 180.0 / G_PI, 60.0);
+  gdouble petal_dist = dist + sin(angle * 6.0) * (cell_size / 8.0);
+  gdouble base_petal_width = cell_size / 10.0;
+  gdouble petal_width = base_petal_width * width_scale;
+  field = fmin (field, fmax (petal_angle - petal_width,
+                             petal_dist - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_checkerboard_waves (gdouble tx,
+                            gdouble ty,
+                            gdouble tile_size,
+                            gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gint cell_x = (gint)(tx / cell_size);
+  gint cell_y = (gint)(ty / cell_size);
+  gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  if ((cell_x + cell_y) % 2 == 0)
+  {
+    field = fmin (field, fabs(cy - (cell_size / 2.0 + wave)) - line_width);
+  }
+  else
+  {
+    wave = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+    field = fmin (field, fabs(cx - (cell_size / 2.0 + wave)) - line_width);
+  }
+
+  return field;
+}
+
+static inline gdouble
+pattern_mosaic_tiles (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  gdouble wave_x = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble wave_y = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  field = fmin (field, fmin (fabs(cx - (cell_size / 2.0 + wave_x)) - line_width,
+                             fabs(cy - (cell_size / 2.0 + wave_y)) - line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_interlocking_gears (gdouble tx,
+                            gdouble ty,
+                            gdouble tile_size,
+                            gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble gear_teeth = sin(angle * 8.0) * (cell_size / 8.0);
+  gdouble gear_dist = dist + gear_teeth;
+  gdouble base_gear_width = cell_size / 10.0;
+  gdouble gear_width = base_gear_width * width_scale;
+  field = fmin (field, fmax (cell_size / 4.0 - gear_width - gear_dist,
+                             gear_dist - (cell_size / 4.0 + gear_width)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_wave_interference (gdouble tx,
+                           gdouble ty,
+                           gdouble tile_size,
+                           gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble wave1 = sin((tx / tile_size) * 4.0 * G_PI) * (tile_size / 10.0);
+  gdouble wave2 = sin((ty / tile_size) * 4.0 * G_PI) * (tile_size / 10.0);
+  gdouble interference = wave1 + wave2;
+  gdouble base_line_width = tile_size / 20.0;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fabs(interference) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_crystal_shards (gdouble tx,
+                        gdouble ty,
+                        gdouble tile_size,
+                        gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble angle = atan2(dy, dx);
+  gdouble angle_mod = fmod(angle * 180.0 / G_PI, 60.0);
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (angle_mod - line_width, dist - center_x));
+
+  return field;
+}
+
+static inline gdouble
+pattern_prism_shards (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble angle = atan2(dy, dx);
+  gdouble angle_mod = fmod(angle * 180.0 / G_PI, 45.0);
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (angle_mod - line_width, dist - center_x));
+
+  return field;
+}
+
+static inline gdouble
+pattern_echo_waves (gdouble tx,
+                    gdouble ty,
+                    gdouble tile_size,
+                    gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble wave_spacing = cell_size / 6.0;
+  gdouble wave_mod = fmod(dist, wave_spacing);
+  gdouble echo = sin(dist * 0.2) * (cell_size / 10.0);
+  gdouble base_line_width = wave_spacing * 0.2;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, wave_mod + echo - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_interlocked_rings (gdouble tx,
+                           gdouble ty,
+                           gdouble tile_size,
+                           gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble ring_spacing = cell_size / 4.0;
+  gdouble ring_mod = fmod(dist, ring_spacing);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, ring_mod - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_pulse_waves (gdouble tx,
+                     gdouble ty,
+                     gdouble tile_size,
+                     gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble pulse = sin(dist * 0.1) * (cell_size / 8.0);
+  gdouble wave_spacing = cell_size / 6.0;
+  gdouble wave_mod = fmod(dist + pulse, wave_spacing);
+  gdouble base_line_width = wave_spacing * 0.2;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, wave_mod - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_woven_threads (gdouble tx,
+                       gdouble ty,
+                       gdouble tile_size,
+                       gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble wave1 = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble wave2 = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  gdouble over_under = sin((tx / tile_size) * 2.0 * G_PI) * sin((ty / tile_size) * 2.0 * G_PI);
+  field = fmin (field, fmax (fabs(cx - (cell_size / 2.0 + wave1)) - line_width,
+                             0 - over_under));
+  field = fmin (field, fmax (fabs(cy - (cell_size / 2.0 + wave2)) - line_width,
+                             -(0 - over_under)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_fractal_waves (gdouble tx,
+                       gdouble ty,
+                       gdouble tile_size,
+                       gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble wave = sin((tx / tile_size) * 4.0 * G_PI) * (tile_size / 10.0);
+  gdouble sub_wave = sin((tx / (tile_size / 2.0)) * 8.0 * G_PI) * (tile_size / 20.0);
+  gdouble wave_y = sin((ty / tile_size) * 4.0 * G_PI) * (tile_size / 10.0);
+  gdouble interference = wave + sub_wave + wave_y;
+  gdouble base_line_width = tile_size / 20.0;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fabs(interference) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_star_weave (gdouble tx,
+                    gdouble ty,
+                    gdouble tile_size,
+                    gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble star_angle = fmod(angle * 180.0 / G_PI, 45.0);
+  gdouble star_dist = dist + sin(angle * 8.0) * (cell_size / 8.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (star_angle - line_width,
+                             star_dist - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_grid_waves_1 (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  field = fmin (field, fmin (fmin (fmin (cx - line_width,
+                                         cell_size - line_width - cx),
+                                   cy - line_width),
+                             cell_size - line_width - cy));
+  field = fmin (field, fabs(cy - (cx + wave)) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_zigzag_weave_1 (gdouble tx,
+                        gdouble ty,
+                        gdouble tile_size,
+                        gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  gdouble zigzag = fabs(fmod(cx, cell_size / 2.0) - cell_size / 4.0);
+  field = fmin (field, fabs(cy - zigzag) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_diamond_grid_1 (gdouble tx,
+                        gdouble ty,
+                        gdouble tile_size,
+                        gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (fabs(cx - cell_size / 2.0) + fabs(cy - cell_size / 2.0) - (cell_size / 4.0 + line_width),
+                             cell_size / 4.0 - line_width - (fabs(cx - cell_size / 2.0) + fabs(cy - cell_size / 2.0))));
+
+  return field;
+}
+
+static inline gdouble
+pattern_tribal_bands_1 (gdouble tx,
+                        gdouble ty,
+                        gdouble tile_size,
+                        gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  gdouble band = fmod(cy, cell_size / 2.0);
+  field = fmin (field, fmin (band - line_width,
+                             fabs(band - cell_size / 4.0) - line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_asanoha_stars_1 (gdouble tx,
+                         gdouble ty,
+                         gdouble tile_size,
+                         gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (fabs(cx - cell_size / 2.0) + fabs(cy - cell_size / 2.0) - (cell_size / 4.0 + line_width),
+                             cell_size / 4.0 - line_width - (fabs(cx - cell_size / 2.0) + fabs(cy - cell_size / 2.0))));
+  field = fmin (field, fabs(cx - cy) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_interlocked_squares_1 (gdouble tx,
+                               gdouble ty,
+                               gdouble tile_size,
+                               gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmin (fmin (fmin (cx - line_width,
+                                         cell_size - line_width - cx),
+                                   cy - line_width),
+                             cell_size - line_width - cy));
+  field = fmin (field, fmax (fmax (fmax (cell_size / 4.0 - line_width - cx,
+                                         cx - (cell_size / 4.0 + line_width)),
+                                   cell_size / 4.0 - line_width - cy),
+                             cy - (cell_size / 4.0 + line_width)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_spiral_maze_1 (gdouble tx,
+                       gdouble ty,
+                       gdouble tile_size,
+                       gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble spiral = dist - (angle * cell_size / (4.0 * G_PI));
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmod(spiral, cell_size / 4.0) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_wave_crests_1 (gdouble tx,
+                       gdouble ty,
+                       gdouble tile_size,
+                       gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (fabs(cy - (cell_size / 2.0 + wave)) - line_width,
+                             cy - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_floral_lattice_1 (gdouble tx,
+                          gdouble ty,
+                          gdouble tile_size,
+                          gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmin (fmin (fmin (cx - line_width,
+                                         cell_size - line_width - cx),
+                                   cy - line_width),
+                             cell_size - line_width - cy));
+  field = fmin (field, fmax (fabs(cx - cell_size / 2.0) - line_width,
+                             fabs(cy - cell_size / 2.0) - line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_chevron_stripes_1 (gdouble tx,
+                           gdouble ty,
+                           gdouble tile_size,
+                           gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cy = fmod(ty, cell_size);
+  gdouble chevron = fabs(fmod(tx, cell_size) - cell_size / 2.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fabs(cy - chevron) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_cherry_blossoms_1 (gdouble tx,
+                           gdouble ty,
+                           gdouble tile_size,
+                           gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble petal_angle = fmod(angle * 180.0 / G_PI, 72.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (petal_angle - line_width,
+                             dist - (cell_size / 4.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_sunburst_motif_1 (gdouble tx,
+                          gdouble ty,
+                          gdouble tile_size,
+                          gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble angle = atan2(dy, dx);
+  gdouble angle_mod = fmod(angle * 180.0 / G_PI, 30.0);
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (angle_mod - line_width, dist - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_meander_1 (gdouble tx,
+                   gdouble ty,
+                   gdouble tile_size,
+                   gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmin (cy - line_width, cell_size - line_width - cy));
+  field = fmin (field, fmax (fmax (cx - (cell_size / 2.0),
+                                   cell_size / 2.0 - line_width - cy),
+                             cy - (cell_size / 2.0 + line_width)));
+  field = fmin (field, fmax (fmax (cell_size / 2.0 - line_width - cx,
+                                   cx - (cell_size / 2.0 + line_width)),
+                             cy - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_double_chevron_bands (gdouble tx,
+                              gdouble ty,
+                              gdouble tile_size,
+                              gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cy = fmod(ty, cell_size);
+  gdouble chevron1 = fabs(fmod(tx, cell_size) - cell_size / 2.0);
+  gdouble chevron2 = fabs(fmod(tx + cell_size / 4.0, cell_size) - cell_size / 2.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmin (fabs(cy - chevron1) - line_width,
+                             fabs(cy - chevron2) - line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_overlapping_circle_waves (gdouble tx,
+                                  gdouble ty,
+                                  gdouble tile_size,
+                                  gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble wave = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
+  gdouble dx = cx - center_x + wave;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (cell_size / 4.0 - line_width - dist,
+                             dist - (cell_size / 4.0 + line_width)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_hexagon_wave_tiles (gdouble tx,
+                            gdouble ty,
+                            gdouble tile_size,
+                            gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble hex_x = cx / (cell_size * 0.866);
+  gdouble hex_y = cy / cell_size;
+  gdouble hex_center_x = floor(hex_x) + 0.5;
+  gdouble hex_center_y = floor(hex_y) + 0.5;
+  if ((gint)floor(hex_y) % 2 == 1) hex_center_x += 0.5;
+  gdouble dx = (hex_x - hex_center_x) * cell_size * 0.866;
+  gdouble dy = (hex_y - hex_center_y) * cell_size;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (cell_size / 2.5 - line_width - dist,
+                             dist - (cell_size / 2.5 + line_width)));
+  field = fmin (field, fmax (dist - (cell_size / 2.5),
+                             fabs(dy - wave) - line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_wave_frieze_1 (gdouble tx,
+                       gdouble ty,
+                       gdouble tile_size,
+                       gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fabs(cy - (cell_size / 2.0 + wave)) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_chevron_grid_overlay (gdouble tx,
+                              gdouble ty,
+                              gdouble tile_size,
+                              gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble chevron = fabs(fmod(cx, cell_size / 2.0) - cell_size / 4.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fabs(cy - chevron) - line_width);
+  field = fmin (field, fmin (fmin (fmin (cx - line_width,
+                                         cell_size - line_width - cx),
+                                   cy - line_width),
+                             cell_size - line_width - cy));
+
+  return field;
+}
+
+static inline gdouble
+pattern_interlocked_squares_2 (gdouble tx,
+                               gdouble ty,
+                               gdouble tile_size,
+                               gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmin (fmin (fmin (cx - line_width,
+                                         cell_size - line_width - cx),
+                                   cy - line_width),
+                             cell_size - line_width - cy));
+  field = fmin (field, fmax (fmax (cell_size / 4.0 - line_width - cx,
+                                   cx - (cell_size / 4.0 + line_width)),
+                             cy - (cell_size / 2.0)));
+  field = fmin (field, fmax (fmax (cell_size / 4.0 - line_width - cy,
+                                   cy - (cell_size / 4.0 + line_width)),
+                             cell_size / 2.0 - cx));
+
+  return field;
+}
+
+static inline gdouble
+pattern_chevron_ripple_effect (gdouble tx,
+                               gdouble ty,
+                               gdouble tile_size,
+                               gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble ripple = sin((tx / tile_size) * 2.0 * G_PI) * (cell_size / 8.0);
+  gdouble chevron = fabs(fmod(cx, cell_size / 2.0) - cell_size / 4.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fabs(cy - (chevron + ripple)) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_circle_lattice_flow (gdouble tx,
+                             gdouble ty,
+                             gdouble tile_size,
+                             gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble flow = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y + flow;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (cell_size / 4.0 - line_width - dist,
+                             dist - (cell_size / 4.0 + line_width)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_palmette_waves_1 (gdouble tx,
+                          gdouble ty,
+                          gdouble tile_size,
+                          gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble angle = atan2(dy, dx);
+  gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
+  gdouble palmette_angle = fmod(angle * 180.0 / G_PI, 90.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (palmette_angle - line_width,
+                             dy + wave - (cell_size / 4.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_spiral_maze_2 (gdouble tx,
+                       gdouble ty,
+                       gdouble tile_size,
+                       gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble spiral = dist - (angle * cell_size / (3.0 * G_PI));
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmod(spiral, cell_size / 3.0) - line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_key_wave_1 (gdouble tx,
+                    gdouble ty,
+                    gdouble tile_size,
+                    gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 6.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmin (cy - line_width, cell_size - line_width - cy));
+  field = fmin (field, fmax (fmax (cell_size / 2.0 - line_width - cx,
+                                   cx - (cell_size / 2.0 + line_width)),
+                             cy + wave - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_anthemion_motif_1 (gdouble tx,
+                           gdouble ty,
+                           gdouble tile_size,
+                           gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble anthemion_angle = fmod(angle * 180.0 / G_PI, 45.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (anthemion_angle - line_width,
+                             dist - (cell_size / 3.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_chevron_maze_1 (gdouble tx,
+                        gdouble ty,
+                        gdouble tile_size,
+                        gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble chevron = fabs(fmod(cx, cell_size / 2.0) - cell_size / 4.0);
+  gdouble base_line_width = cell_size * 0.1;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmin (cy - line_width, cell_size - line_width - cy));
+  field = fmin (field, fmax (fabs(cx - chevron) - line_width,
+                             cy - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_star_frieze_1 (gdouble tx,
+                       gdouble ty,
+                       gdouble tile_size,
+                       gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble star_angle = fmod(angle * 180.0 / G_PI, 45.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (fmax (star_angle - line_width,
+                                   cell_size / 4.0 - dist),
+                             dist - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_lotus_wave_1 (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
+  gdouble lotus_angle = fmod(angle * 180.0 / G_PI, 60.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (lotus_angle - line_width,
+                             dist + wave - (cell_size / 3.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_star_lattice_1 (gdouble tx,
+                        gdouble ty,
+                        gdouble tile_size,
+                        gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble star_angle = fmod(angle * 180.0 / G_PI, 45.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (fmax (star_angle - line_width,
+                                   cell_size / 3.0 - dist),
+                             dist - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_rosette_pattern_1 (gdouble tx,
+                           gdouble ty,
+                           gdouble tile_size,
+                           gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble rosette_angle = fmod(angle * 180.0 / G_PI, 36.0);
+  gdouble base_line_width = cell_size * 0.05;
+  gdouble line_width = base_line_width * width_scale;
+  field = fmin (field, fmax (fmax (rosette_angle - line_width,
+                                   cell_size / 4.0 - dist),
+                             dist - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_concentric_rings (gdouble tx,
+                          gdouble ty,
+                          gdouble tile_size,
+                          gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble ring_spacing = cell_size / 8.0;
+  gdouble ring_mod = fmod(dist, ring_spacing);
+  gdouble base_line_width = cell_size * 0.1 * width_scale;
+  field = fmin (field, fmax (ring_mod - base_line_width,
+                             dist - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_wavy_stripes (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble wave = sin((tx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble stripe = fmod(ty + wave, cell_size / 2.0);
+  gdouble base_line_width = cell_size * 0.2 * width_scale;
+  field = fmin (field, stripe - base_line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_zigzag_stripes (gdouble tx,
+                        gdouble ty,
+                        gdouble tile_size,
+                        gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble diag_x = (tx + ty) / sqrt(2.0);
+  gdouble diag_y = (ty - tx) / sqrt(2.0);
+  gdouble cd = fmod(diag_x, cell_size);
+  gdouble zigzag = fabs(fmod(cd, cell_size / 2.0) - cell_size / 4.0) * 2.0 - cell_size / 4.0;
+  gdouble stripe = fmod(diag_y + zigzag, cell_size / 2.0);
+  gdouble base_line_width = cell_size * 0.2 * width_scale;
+  field = fmin (field, stripe - base_line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_twisted_ribbons (gdouble tx,
+                         gdouble ty,
+                         gdouble tile_size,
+                         gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble amplitude = (cell_size / 4.0) * sin(ty * G_PI / cell_size);
+  gdouble wave = sin((ty / cell_size) * 2.0 * G_PI) * amplitude;
+  gdouble stripe = fmod(tx + wave, cell_size / 2.0);
+  gdouble base_line_width = cell_size * 0.2 * width_scale;
+  field = fmin (field, stripe - base_line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_interfering_waves (gdouble tx,
+                           gdouble ty,
+                           gdouble tile_size,
+                           gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble wave_h = sin((tx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble stripe_h = fmod(ty + wave_h, cell_size / 2.0);
+  gdouble wave_v = sin((ty / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
+  gdouble stripe_v = fmod(tx + wave_v, cell_size / 2.0);
+  gdouble base_line_width = cell_size * 0.2 * width_scale;
+  field = fmin (field, fmin (stripe_h - base_line_width,
+                             stripe_v - base_line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_curved_bands (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cy = fmod(ty, cell_size);
+  gdouble curve = sin((tx / cell_size) * 1.5 * G_PI) * (cell_size / 3.0);
+  gdouble band = fmod(cy + curve, cell_size / 2.0);
+  gdouble base_line_width = cell_size * 0.15 * width_scale;
+  field = fmin (field, band - base_line_width);
+
+  return field;
+}
+
+static inline gdouble
+pattern_wave_cross (gdouble tx,
+                    gdouble ty,
+                    gdouble tile_size,
+                    gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble wave_x = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 5.0);
+  gdouble wave_y = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 5.0);
+  gdouble base_line_width = cell_size * 0.1 * width_scale;
+  field = fmin (field, fmin (fabs(cx - (cell_size / 2.0 + wave_x)) - base_line_width,
+                             fabs(cy - (cell_size / 2.0 + wave_y)) - base_line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_ripple_grid (gdouble tx,
+                     gdouble ty,
+                     gdouble tile_size,
+                     gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble ripple = sin(dist * 0.2) * (cell_size / 10.0);
+  gdouble base_line_width = cell_size * 0.1 * width_scale;
+  field = fmin (field, fmin (fmod(cx + ripple, cell_size / 4.0) - base_line_width,
+                             fmod(cy + ripple, cell_size / 4.0) - base_line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_petal_grid (gdouble tx,
+                    gdouble ty,
+                    gdouble tile_size,
+                    gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble petal_angle = fmod(angle * 180.0 / G_PI, 40.0);
+  gdouble base_line_width = cell_size * 0.06 * width_scale;
+  field = fmin (field, fmax (petal_angle - base_line_width,
+                             dist - (cell_size / 3.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_wave_spikes (gdouble tx,
+                     gdouble ty,
+                     gdouble tile_size,
+                     gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble spike_angle = fmod(angle * 180.0 / G_PI, 30.0);
+  gdouble wave = sin(dist * 0.3) * (cell_size / 10.0);
+  gdouble base_line_width = cell_size * 0.06 * width_scale;
+  field = fmin (field, fmax (spike_angle - base_line_width,
+                             dist + wave - (cell_size / 2.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_circle_weave (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble wave_x = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 6.0);
+  gdouble wave_y = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 6.0);
+  gdouble base_line_width = cell_size * 0.08 * width_scale;
+  field = fmin (field, fmax (fmax (cell_size / 3.0 - base_line_width - dist,
+                                   dist - (cell_size / 3.0 + base_line_width)),
+                             fmin (fabs(dx - wave_x) - base_line_width,
+                                   fabs(dy - wave_y) - base_line_width)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_grid_swirls (gdouble tx,
+                     gdouble ty,
+                     gdouble tile_size,
+                     gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble swirl = dist + angle * cell_size / (4.0 * G_PI);
+  gdouble grid_mod = fmod(cx, cell_size / 3.0) + fmod(cy, cell_size / 3.0);
+  gdouble base_line_width = cell_size * 0.1 * width_scale;
+  field = fmin (field, fmax (fmod(swirl, cell_size / 4.0) - base_line_width,
+                             grid_mod - (cell_size / 3.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_braided_strips (gdouble tx,
+                        gdouble ty,
+                        gdouble tile_size,
+                        gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble wave1 = sin((cx / cell_size) * 1.5 * G_PI) * (cell_size / 4.0);
+  gdouble wave2 = sin((cx / cell_size) * 1.5 * G_PI + G_PI / 2.0) * (cell_size / 4.0);
+  gdouble base_line_width = cell_size * 0.1 * width_scale;
+  field = fmin (field, fmin (fabs(cy - (cell_size / 2.0 + wave1)) - base_line_width,
+                             fabs(cy - (cell_size / 2.0 + wave2)) - base_line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_wave_lattice (gdouble tx,
+                      gdouble ty,
+                      gdouble tile_size,
+                      gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble wave = sin((cx + cy) / cell_size * 2.0 * G_PI) * (cell_size / 5.0);
+  gdouble base_line_width = cell_size * 0.1 * width_scale;
+  field = fmin (field, fmin (fmod(cx + wave, cell_size / 4.0) - base_line_width,
+                             fmod(cy + wave, cell_size / 4.0) - base_line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_loop_motif (gdouble tx,
+                    gdouble ty,
+                    gdouble tile_size,
+                    gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 5.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble center_x = cell_size / 2.0;
+  gdouble center_y = cell_size / 2.0;
+  gdouble dx = cx - center_x;
+  gdouble dy = cy - center_y;
+  gdouble dist = sqrt(dx * dx + dy * dy);
+  gdouble angle = atan2(dy, dx);
+  gdouble loop_angle = fmod(angle * 180.0 / G_PI, 90.0);
+  gdouble loop_dist = dist + sin(angle * 4.0) * (cell_size / 10.0);
+  gdouble base_line_width = cell_size * 0.06 * width_scale;
+  field = fmin (field, fmax (loop_angle - base_line_width,
+                             loop_dist - (cell_size / 3.0)));
+
+  return field;
+}
+
+static inline gdouble
+pattern_curve_maze (gdouble tx,
+                    gdouble ty,
+                    gdouble tile_size,
+                    gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble curve = sin((cx / cell_size) * 1.5 * G_PI) * (cell_size / 3.0);
+  gdouble maze = fmod(cy + curve, cell_size / 3.0);
+  gdouble base_line_width = cell_size * 0.1 * width_scale;
+  field = fmin (field, fmin (maze - base_line_width,
+                             fmod(cx, cell_size / 3.0) - base_line_width));
+
+  return field;
+}
+
+static inline gdouble
+pattern_pulse_grid (gdouble tx,
+                    gdouble ty,
+                    gdouble tile_size,
+                    gdouble width_scale)
+{
+  gdouble field = SW_FAR;
+  gdouble cell_size = tile_size / 4.0;
+  gdouble cx = fmod(tx, cell_size);
+  gdouble cy = fmod(ty, cell_size);
+  gdouble pulse = sin((cx + cy) / cell_size * 2.0 * G_PI) * (cell_size / 6.0);
+  gdouble base_line_width = cell_size * 0.1 * width_scale;
+  field = fmin (field, fmax (fmod(cx + pulse, cell_size / 4.0) - base_line_width,
+                             fmod(cy + pulse, cell_size / 4.0) - base_line_width));
+
+  return field;
+}
+
+typedef struct
+{
+  gdouble tile_size;
+  gdouble width_scale;
+  gdouble cos_rot;
+  gdouble sin_rot;
+} PatternParams;
+
+static inline void
+tile_coords (const PatternParams *pp,
+             gdouble              px,
+             gdouble              py,
+             gdouble             *tx,
+             gdouble             *ty)
+{
+  // Apply rotation to the original pixel coordinates around (0, 0)
+  gdouble px_rot = px * pp->cos_rot - py * pp->sin_rot;
+  gdouble py_rot = px * pp->sin_rot + py * pp->cos_rot;
+
+  // Map rotated coordinates to tile space
+  *tx = fmod(px_rot, pp->tile_size);
+  *ty = fmod(py_rot, pp->tile_size);
+  if (*tx < 0) *tx += pp->tile_size;
+  if (*ty < 0) *ty += pp->tile_size;
+}
+
+/* One specialized span loop per pattern, so the pattern switch happens
+ * once per row instead of once per pixel and each field is inlined into
+ * its own loop.  A span covers n samples starting at (px, py) in full
+ * resolution coordinates, step apart horizontally.
+ */
+typedef void (* PatternSpanFunc) (const PatternParams *pp,
+                                  gdouble              px,
+                                  gdouble              py,
+                                  gdouble              step,
+                                  glong                n,
+                                  gfloat              *field);
+
+#define PATTERN_SPAN(name)                                              \
+static void                                                             \
+span_##name (const PatternParams *pp,                                   \
+             gdouble              px,                                   \
+             gdouble              py,                                   \
+             gdouble              step,                                 \
+             glong                n,                                    \
+             gfloat              *field)                                \
+{                                                                       \
+  glong i;                                                              \
+                                                                        \
+  for (i = 0; i < n; i++)                                               \
+    {                                                                   \
+      gdouble tx, ty;                                                   \
+                                                                        \
+      tile_coords (pp, px + i * step, py, &tx, &ty);                    \
+      field[i] = pattern_##name (tx, ty, pp->tile_size, pp->width_scale); \
+    }                                                                   \
+}
+
+PATTERN_SPAN (lattice_1)
+PATTERN_SPAN (ripple_effect)
+PATTERN_SPAN (petal_swirls)
+PATTERN_SPAN (checkerboard_waves)
+PATTERN_SPAN (mosaic_tiles)
+PATTERN_SPAN (interlocking_gears)
+PATTERN_SPAN (wave_interference)
+PATTERN_SPAN (crystal_shards)
+PATTERN_SPAN (prism_shards)
+PATTERN_SPAN (echo_waves)
+PATTERN_SPAN (interlocked_rings)
+PATTERN_SPAN (pulse_waves)
+PATTERN_SPAN (woven_threads)
+PATTERN_SPAN (fractal_waves)
+PATTERN_SPAN (star_weave)
+PATTERN_SPAN (grid_waves_1)
+PATTERN_SPAN (zigzag_weave_1)
+PATTERN_SPAN (diamond_grid_1)
+PATTERN_SPAN (tribal_bands_1)
+PATTERN_SPAN (asanoha_stars_1)
+PATTERN_SPAN (interlocked_squares_1)
+PATTERN_SPAN (spiral_maze_1)
+PATTERN_SPAN (wave_crests_1)
+PATTERN_SPAN (floral_lattice_1)
+PATTERN_SPAN (chevron_stripes_1)
+PATTERN_SPAN (cherry_blossoms_1)
+PATTERN_SPAN (sunburst_motif_1)
+PATTERN_SPAN (meander_1)
+PATTERN_SPAN (double_chevron_bands)
+PATTERN_SPAN (overlapping_circle_waves)
+PATTERN_SPAN (hexagon_wave_tiles)
+PATTERN_SPAN (wave_frieze_1)
+PATTERN_SPAN (chevron_grid_overlay)
+PATTERN_SPAN (interlocked_squares_2)
+PATTERN_SPAN (chevron_ripple_effect)
+PATTERN_SPAN (circle_lattice_flow)
+PATTERN_SPAN (palmette_waves_1)
+PATTERN_SPAN (spiral_maze_2)
+PATTERN_SPAN (key_wave_1)
+PATTERN_SPAN (anthemion_motif_1)
+PATTERN_SPAN (chevron_maze_1)
+PATTERN_SPAN (star_frieze_1)
+PATTERN_SPAN (lotus_wave_1)
+PATTERN_SPAN (star_lattice_1)
+PATTERN_SPAN (rosette_pattern_1)
+PATTERN_SPAN (concentric_rings)
+PATTERN_SPAN (wavy_stripes)
+PATTERN_SPAN (zigzag_stripes)
+PATTERN_SPAN (twisted_ribbons)
+PATTERN_SPAN (interfering_waves)
+PATTERN_SPAN (curved_bands)
+PATTERN_SPAN (wave_cross)
+PATTERN_SPAN (ripple_grid)
+PATTERN_SPAN (petal_grid)
+PATTERN_SPAN (wave_spikes)
+PATTERN_SPAN (circle_weave)
+PATTERN_SPAN (grid_swirls)
+PATTERN_SPAN (braided_strips)
+PATTERN_SPAN (wave_lattice)
+PATTERN_SPAN (loop_motif)
+PATTERN_SPAN (curve_maze)
+PATTERN_SPAN (pulse_grid)
+
+/* Coverage for rows of pixels, from a sliding window of three field rows
+ * one sample wider than the span on either side.  The field over its
+ * screen space gradient is the distance to the edge in pixels, which
+ * gives the coverage of a one pixel wide box.  Each axis takes the
+ * smaller one-sided difference so the jump where a pattern wraps around
+ * its cell is not mistaken for a steep edge; where both sides jump, or
+ * antialiasing is off, the pixel is simply in or out.
+ */
+typedef struct
+{
+  PatternSpanFunc      span;
+  const PatternParams *pp;
+  gboolean             antialias;
+  gdouble              px;
+  gdouble              py;
+  gdouble              step;
+  glong                n;
+  gfloat              *storage;
+  gfloat              *field[3];
+} CoverageRows;
+
+static void
+coverage_rows_init (CoverageRows        *cr,
+                    PatternSpanFunc      span,
+                    const PatternParams *pp,
+                    gboolean             antialias,
+                    gdouble              px,
+                    gdouble              py,
+                    gdouble              step,
+                    glong                n)
+{
+  cr->span = span;
+  cr->pp = pp;
+  cr->antialias = antialias;
+  cr->px = px - step;
+  cr->py = py;
+  cr->step = step;
+  cr->n = n;
+  cr->storage = g_new (gfloat, 3 * (n + 2));
+  cr->field[0] = cr->storage;
+  cr->field[1] = cr->field[0] + n + 2;
+  cr->field[2] = cr->field[1] + n + 2;
+
+  if (antialias)
+    {
+      span (pp, cr->px, py - step, step, n + 2, cr->field[0]);
+      span (pp, cr->px, py, step, n + 2, cr->field[1]);
+      cr->py += step;
+    }
+}
+
+static void
+coverage_rows_next (CoverageRows *cr,
+                    gfloat       *coverage)
+{
+  const gfloat *up, *mid, *down;
+  gfloat       *tmp;
+  glong         i;
+
+  if (!cr->antialias)
+    {
+      cr->span (cr->pp, cr->px + cr->step, cr->py, cr->step, cr->n, cr->field[1]);
+      for (i = 0; i < cr->n; i++)
+        coverage[i] = signbit (cr->field[1][i]) ? 1.0f : 0.0f;
+      cr->py += cr->step;
+      return;
+    }
+
+  cr->span (cr->pp, cr->px, cr->py, cr->step, cr->n + 2, cr->field[2]);
+  up = cr->field[0] + 1;
+  mid = cr->field[1] + 1;
+  down = cr->field[2] + 1;
+
+  for (i = 0; i < cr->n; i++)
+    {
+      gfloat f = mid[i];
+      gfloat dx = MIN (fabsf (f - mid[i - 1]), fabsf (mid[i + 1] - f));
+      gfloat dy = MIN (fabsf (f - up[i]), fabsf (down[i] - f));
+      gfloat gradient = sqrtf (dx * dx + dy * dy);
+
+      if (gradient > 0.0f && fabsf (f) < SW_FAR / 2)
+        coverage[i] = CLAMP (0.5f - f / gradient, 0.0f, 1.0f);
+      else
+        coverage[i] = signbit (f) ? 1.0f : 0.0f;
+    }
+
+  tmp = cr->field[0];
+  cr->field[0] = cr->field[1];
+  cr->field[1] = cr->field[2];
+  cr->field[2] = tmp;
+  cr->py += cr->step;
+}
+
+static void
+coverage_rows_free (CoverageRows *cr)
+{
+  g_free (cr->storage);
+}
+
+static const PatternSpanFunc pattern_spans[] =
+{
+  [LATTICE_1] = span_lattice_1,
+  [RIPPLE_EFFECT] = span_ripple_effect,
+  [PETAL_SWIRLS] = span_petal_swirls,
+  [CHECKERBOARD_WAVES] = span_checkerboard_waves,
+  [MOSAIC_TILES] = span_mosaic_tiles,
+  [INTERLOCKING_GEARS] = span_interlocking_gears,
+  [WAVE_INTERFERENCE] = span_wave_interference,
+  [CRYSTAL_SHARDS] = span_crystal_shards,
+  [PRISM_SHARDS] = span_prism_shards,
+  [ECHO_WAVES] = span_echo_waves,
+  [INTERLOCKED_RINGS] = span_interlocked_rings,
+  [PULSE_WAVES] = span_pulse_waves,
+  [WOVEN_THREADS] = span_woven_threads,
+  [FRACTAL_WAVES] = span_fractal_waves,
+  [STAR_WEAVE] = span_star_weave,
+  [GRID_WAVES_1] = span_grid_waves_1,
+  [ZIGZAG_WEAVE_1] = span_zigzag_weave_1,
+  [DIAMOND_GRID_1] = span_diamond_grid_1,
+  [TRIBAL_BANDS_1] = span_tribal_bands_1,
+  [ASANOHA_STARS_1] = span_asanoha_stars_1,
+  [INTERLOCKED_SQUARES_1] = span_interlocked_squares_1,
+  [SPIRAL_MAZE_1] = span_spiral_maze_1,
+  [WAVE_CRESTS_1] = span_wave_crests_1,
+  [FLORAL_LATTICE_1] = span_floral_lattice_1,
+  [CHEVRON_STRIPES_1] = span_chevron_stripes_1,
+  [CHERRY_BLOSSOMS_1] = span_cherry_blossoms_1,
+  [SUNBURST_MOTIF_1] = span_sunburst_motif_1,
+  [MEANDER_1] = span_meander_1,
+  [DOUBLE_CHEVRON_BANDS] = span_double_chevron_bands,
+  [OVERLAPPING_CIRCLE_WAVES] = span_overlapping_circle_waves,
+  [HEXAGON_WAVE_TILES] = span_hexagon_wave_tiles,
+  [WAVE_FRIEZE_1] = span_wave_frieze_1,
+  [CHEVRON_GRID_OVERLAY] = span_chevron_grid_overlay,
+  [INTERLOCKED_SQUARES_2] = span_interlocked_squares_2,
+  [CHEVRON_RIPPLE_EFFECT] = span_chevron_ripple_effect,
+  [CIRCLE_LATTICE_FLOW] = span_circle_lattice_flow,
+  [PALMETTE_WAVES_1] = span_palmette_waves_1,
+  [SPIRAL_MAZE_2] = span_spiral_maze_2,
+  [KEY_WAVE_1] = span_key_wave_1,
+  [ANTHEMION_MOTIF_1] = span_anthemion_motif_1,
+  [CHEVRON_MAZE_1] = span_chevron_maze_1,
+  [STAR_FRIEZE_1] = span_star_frieze_1,
+  [LOTUS_WAVE_1] = span_lotus_wave_1,
+  [STAR_LATTICE_1] = span_star_lattice_1,
+  [ROSETTE_PATTERN_1] = span_rosette_pattern_1,
+  [CONCENTRIC_RINGS] = span_concentric_rings,
+  [WAVY_STRIPES] = span_wavy_stripes,
+  [ZIGZAG_STRIPES] = span_zigzag_stripes,
+  [TWISTED_RIBBONS] = span_twisted_ribbons,
+  [INTERFERING_WAVES] = span_interfering_waves,
+  [CURVED_BANDS] = span_curved_bands,
+  [WAVE_CROSS] = span_wave_cross,
+  [RIPPLE_GRID] = span_ripple_grid,
+  [PETAL_GRID] = span_petal_grid,
+  [WAVE_SPIKES] = span_wave_spikes,
+  [CIRCLE_WEAVE] = span_circle_weave,
+  [GRID_SWIRLS] = span_grid_swirls,
+  [BRAIDED_STRIPS] = span_braided_strips,
+  [WAVE_LATTICE] = span_wave_lattice,
+  [LOOP_MOTIF] = span_loop_motif,
+  [CURVE_MAZE] = span_curve_maze,
+  [PULSE_GRID] = span_pulse_grid,
+};
+
+/* The tile cache holds one tile period of the unrotated pattern as a
+ * size x size coverage mask, size = ceil (tile_size).  It lives in tile
+ * space, so rotation is not part of the key; it is (re)built in prepare
+ * (), before any worker thread runs process ().
+ */
+typedef struct
+{
+  gint     pattern;
+  gdouble  tile_size;
+  gdouble  width_scale;
+  gboolean antialias;
+  gint     size;
+  guint8  *mask;
+} SwTileCache;
+
+static void
+update_tile_cache (GeglProperties *o)
+{
+  SwTileCache  *cache = o->user_data;
+  PatternParams pp = { o->tile_size, o->line_width, 1.0, 0.0 };
+  CoverageRows  rows;
+  gfloat       *coverage;
+  gdouble       step;
+  gint          i, j;
+
+  if (!cache)
+    o->user_data = cache = g_new0 (SwTileCache, 1);
+
+  if (cache->mask &&
+      cache->pattern == o->pattern &&
+      cache->tile_size == o->tile_size &&
+      cache->width_scale == o->line_width &&
+      cache->antialias == o->antialias)
+    return;
+
+  g_free (cache->mask);
+  cache->pattern = o->pattern;
+  cache->tile_size = o->tile_size;
+  cache->width_scale = o->line_width;
+  cache->antialias = o->antialias;
+  cache->size = (gint) ceil (o->tile_size);
+  cache->mask = g_new (guint8, (gsize) cache->size * cache->size);
+
+  step = o->tile_size / cache->size;
+  coverage = g_new (gfloat, cache->size);
+  coverage_rows_init (&rows, pattern_spans[o->pattern], &pp, o->antialias,
+                      0.0, 0.0, step, cache->size);
+
+  for (j = 0; j < cache->size; j++)
+  {
+    guint8 *row = cache->mask + (gsize) j * cache->size;
+
+    coverage_rows_next (&rows, coverage);
+    for (i = 0; i < cache->size; i++)
+      row[i] = (guint8) (coverage[i] * 255.0f + 0.5f);
+  }
+
+  coverage_rows_free (&rows);
+  g_free (coverage);
+}
+
+static void
+finalize (GObject *object)
+{
+  GeglOp *self = GEGL_OP (object);
+  GeglProperties *o = GEGL_PROPERTIES (self);
+  SwTileCache *cache = o->user_data;
+
+  if (cache)
+    {
+      g_free (cache->mask);
+      g_free (cache);
+      o->user_data = NULL;
+    }
+  G_OBJECT_CLASS (gegl_op_parent_class)->finalize (object);
+}
 
 static void prepare (GeglOperation *operation)
 {
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+
   gegl_operation_set_format (operation, "output", babl_format ("RGBA float"));
+
+  if (o->tile_cache)
+    update_tile_cache (o);
 }
 
-static GeglRectangle get_bounding_box (GeglOperation *operation)
+/* Fills n pixels from the cached mask; whole-pixel steps along an
+ * unrotated row just walk a mask row, the general case maps every pixel
+ * to tile space first.
+ */
+static void
+render_from_cache (const SwTileCache    *cache,
+                   const PatternParams  *pp,
+                   const gfloat          colors[256][4],
+                   gdouble               px,
+                   gdouble               py,
+                   gint                  step,
+                   glong                 n,
+                   gfloat               *out)
 {
-  return gegl_rectangle_infinite_plane ();
+  const gdouble scale = cache->size / pp->tile_size;
+  glong i;
+
+  if (pp->sin_rot == 0.0 && pp->cos_rot == 1.0 && cache->size == pp->tile_size)
+    {
+      gdouble tx, ty;
+      gint    ix;
+      const guint8 *row;
+
+      tile_coords (pp, px, py, &tx, &ty);
+      ix = (gint) tx;
+      row = cache->mask + (gsize) MIN ((gint) ty, cache->size - 1) * cache->size;
+
+      for (i = 0; i < n; i++)
+        {
+          memcpy (out, colors[row[ix]], 4 * sizeof (gfloat));
+          out += 4;
+          ix += step;
+          while (ix >= cache->size)
+            ix -= cache->size;
+        }
+      return;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      gdouble tx, ty;
+      gint    ix, iy;
+
+      tile_coords (pp, px + i * step, py, &tx, &ty);
+      ix = MIN ((gint) (tx * scale), cache->size - 1);
+      iy = MIN ((gint) (ty * scale), cache->size - 1);
+
+      memcpy (out, colors[cache->mask[(gsize) iy * cache->size + ix]],
+              4 * sizeof (gfloat));
+      out += 4;
+    }
 }
 
+static GrokTraceOp *trace_op;
+
+/* GEGL hands this one tile-sized roi at a time, from as many threads as
+ * it has; out_buf is RGBA float for exactly roi, in row order.
+ */
 static gboolean
-process (GeglOperation        *operation,
-         GeglOperationContext *context,
-         const gchar          *output_prop,
-         const GeglRectangle  *result,
+process (GeglOperation       *operation,
+         void                *out_buf,
+         glong                n_pixels,
+         const GeglRectangle *roi,
          gint                 level)
 {
   GeglProperties *o = GEGL_PROPERTIES (operation);
-  GeglBuffer *output = gegl_operation_context_get_target (context, output_prop);
+  SwTileCache *cache = o->user_data;
+  PatternParams pp;
+  CoverageRows rows;
+  gfloat *out_pixel = out_buf;
+  gfloat *coverage = NULL;
   gdouble fg_color[4], bg_color[4];
-  gdouble tile_size = o->tile_size;
-  GeglRectangle rect = *result;
+  const gint factor = 1 << level;
   gint x, y;
+  GrokTraceSpan span;
+
+  grok_trace_begin (&span, trace_op, roi, level);
 
   // Get color values
   gegl_color_get_rgba (o->foreground_color, &fg_color[0], &fg_color[1], &fg_color[2], &fg_color[3]);
@@ -154,1193 +1984,116 @@ process (GeglOperation        *operation,
 
   // Convert rotation to radians
   gdouble rotation_rad = o->rotation * G_PI / 180.0;
-  gdouble cos_rot = cos(rotation_rad);
-  gdouble sin_rot = sin(rotation_rad);
+  pp.tile_size = o->tile_size;
+  pp.width_scale = o->line_width;
+  pp.cos_rot = cos(rotation_rad);
+  pp.sin_rot = sin(rotation_rad);
 
-  for (y = rect.y; y < rect.y + rect.height; y++)
+  if (o->tile_cache && cache && cache->mask)
   {
-    for (x = rect.x; x < rect.x + rect.width; x++)
+    gfloat colors[256][4];
+    gint   i, c;
+
+    // Exact axes when unrotated, so rows can walk the mask directly
+    if (fmod (o->rotation, 360.0) == 0.0)
     {
-      gdouble px = (gdouble)x;
-      gdouble py = (gdouble)y;
+      pp.cos_rot = 1.0;
+      pp.sin_rot = 0.0;
+    }
 
-      // Apply rotation to the original pixel coordinates around (0, 0)
-      gdouble px_rot = px * cos_rot - py * sin_rot;
-      gdouble py_rot = px * sin_rot + py * cos_rot;
+    for (i = 0; i < 256; i++)
+    {
+      for (c = 0; c < 3; c++)
+        colors[i][c] = bg_color[c] + (fg_color[c] - bg_color[c]) * (i / 255.0);
+      colors[i][3] = 1.0;
+    }
 
-      // Map rotated coordinates to tile space
-      gdouble tx = fmod(px_rot, tile_size);
-      gdouble ty = fmod(py_rot, tile_size);
-      if (tx < 0) tx += tile_size;
-      if (ty < 0) ty += tile_size;
+    for (y = roi->y; y < roi->y + roi->height; y++)
+    {
+      render_from_cache (cache, &pp, (const gfloat (*)[4]) colors,
+                         (gdouble) roi->x * factor, (gdouble) y * factor,
+                         factor, roi->width, out_pixel);
+      out_pixel += roi->width * 4;
+    }
 
-      gfloat out[4];
-      gboolean in_shape = FALSE;
+    grok_trace_end (&span, n_pixels);
+    return TRUE;
+  }
 
-      switch (o->pattern)
-      {
-        case LATTICE_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-
-          if (cx < line_width || cx > cell_size - line_width ||
-              cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (fabs(cx - cy) < line_width || fabs(cx + cy - cell_size) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case RIPPLE_EFFECT:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble ripple_spacing = cell_size / 8.0;
-          gdouble ripple_dist = fmod(dist, ripple_spacing);
-          gdouble base_line_width = ripple_spacing * 0.2;
-          gdouble line_width = base_line_width * o->line_width;
-          if (ripple_dist < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case PETAL_SWIRLS:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble petal_angle = fmod(angle * 180.0 / G_PI, 60.0);
-          gdouble petal_dist = dist + sin(angle * 6.0) * (cell_size / 8.0);
-          gdouble base_petal_width = cell_size / 10.0;
-          gdouble petal_width = base_petal_width * o->line_width;
-          if (petal_angle < petal_width && petal_dist < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CHECKERBOARD_WAVES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gint cell_x = (gint)(tx / cell_size);
-          gint cell_y = (gint)(ty / cell_size);
-          gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if ((cell_x + cell_y) % 2 == 0)
-          {
-            if (fabs(cy - (cell_size / 2.0 + wave)) < line_width)
-            {
-              in_shape = TRUE;
-            }
-          }
-          else
-          {
-            wave = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-            if (fabs(cx - (cell_size / 2.0 + wave)) < line_width)
-            {
-              in_shape = TRUE;
-            }
-          }
-          break;
-        }
-        case MOSAIC_TILES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          gdouble wave_x = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble wave_y = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          if (fabs(cx - (cell_size / 2.0 + wave_x)) < line_width ||
-              fabs(cy - (cell_size / 2.0 + wave_y)) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case INTERLOCKING_GEARS:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble gear_teeth = sin(angle * 8.0) * (cell_size / 8.0);
-          gdouble gear_dist = dist + gear_teeth;
-          gdouble base_gear_width = cell_size / 10.0;
-          gdouble gear_width = base_gear_width * o->line_width;
-          if (gear_dist > cell_size / 4.0 - gear_width && gear_dist < cell_size / 4.0 + gear_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case WAVE_INTERFERENCE:
-        {
-          gdouble wave1 = sin((tx / tile_size) * 4.0 * G_PI) * (tile_size / 10.0);
-          gdouble wave2 = sin((ty / tile_size) * 4.0 * G_PI) * (tile_size / 10.0);
-          gdouble interference = wave1 + wave2;
-          gdouble base_line_width = tile_size / 20.0;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(interference) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CRYSTAL_SHARDS:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble angle = atan2(dy, dx);
-          gdouble angle_mod = fmod(angle * 180.0 / G_PI, 60.0);
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (angle_mod < line_width && dist < center_x)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case PRISM_SHARDS:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble angle = atan2(dy, dx);
-          gdouble angle_mod = fmod(angle * 180.0 / G_PI, 45.0);
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (angle_mod < line_width && dist < center_x)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case ECHO_WAVES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble wave_spacing = cell_size / 6.0;
-          gdouble wave_mod = fmod(dist, wave_spacing);
-          gdouble echo = sin(dist * 0.2) * (cell_size / 10.0);
-          gdouble base_line_width = wave_spacing * 0.2;
-          gdouble line_width = base_line_width * o->line_width;
-          if (wave_mod + echo < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case INTERLOCKED_RINGS:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble ring_spacing = cell_size / 4.0;
-          gdouble ring_mod = fmod(dist, ring_spacing);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (ring_mod < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case PULSE_WAVES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble pulse = sin(dist * 0.1) * (cell_size / 8.0);
-          gdouble wave_spacing = cell_size / 6.0;
-          gdouble wave_mod = fmod(dist + pulse, wave_spacing);
-          gdouble base_line_width = wave_spacing * 0.2;
-          gdouble line_width = base_line_width * o->line_width;
-          if (wave_mod < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case WOVEN_THREADS:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble wave1 = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble wave2 = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          gdouble over_under = sin((tx / tile_size) * 2.0 * G_PI) * sin((ty / tile_size) * 2.0 * G_PI);
-          if (fabs(cx - (cell_size / 2.0 + wave1)) < line_width && over_under > 0)
-          {
-            in_shape = TRUE;
-          }
-          if (fabs(cy - (cell_size / 2.0 + wave2)) < line_width && over_under <= 0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case FRACTAL_WAVES:
-        {
-          gdouble wave = sin((tx / tile_size) * 4.0 * G_PI) * (tile_size / 10.0);
-          gdouble sub_wave = sin((tx / (tile_size / 2.0)) * 8.0 * G_PI) * (tile_size / 20.0);
-          gdouble wave_y = sin((ty / tile_size) * 4.0 * G_PI) * (tile_size / 10.0);
-          gdouble interference = wave + sub_wave + wave_y;
-          gdouble base_line_width = tile_size / 20.0;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(interference) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case STAR_WEAVE:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble star_angle = fmod(angle * 180.0 / G_PI, 45.0);
-          gdouble star_dist = dist + sin(angle * 8.0) * (cell_size / 8.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (star_angle < line_width && star_dist < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case GRID_WAVES_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          if (cx < line_width || cx > cell_size - line_width ||
-              cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (fabs(cy - (cx + wave)) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case ZIGZAG_WEAVE_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          gdouble zigzag = fabs(fmod(cx, cell_size / 2.0) - cell_size / 4.0);
-          if (fabs(cy - zigzag) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case DIAMOND_GRID_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(cx - cell_size / 2.0) + fabs(cy - cell_size / 2.0) < cell_size / 4.0 + line_width &&
-              fabs(cx - cell_size / 2.0) + fabs(cy - cell_size / 2.0) > cell_size / 4.0 - line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case TRIBAL_BANDS_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          gdouble band = fmod(cy, cell_size / 2.0);
-          if (band < line_width || fabs(band - cell_size / 4.0) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case ASANOHA_STARS_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(cx - cell_size / 2.0) + fabs(cy - cell_size / 2.0) < cell_size / 4.0 + line_width &&
-              fabs(cx - cell_size / 2.0) + fabs(cy - cell_size / 2.0) > cell_size / 4.0 - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (fabs(cx - cy) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case INTERLOCKED_SQUARES_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (cx < line_width || cx > cell_size - line_width ||
-              cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (cx > cell_size / 4.0 - line_width && cx < cell_size / 4.0 + line_width &&
-                   cy > cell_size / 4.0 - line_width && cy < cell_size / 4.0 + line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case SPIRAL_MAZE_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble spiral = dist - (angle * cell_size / (4.0 * G_PI));
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fmod(spiral, cell_size / 4.0) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case WAVE_CRESTS_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(cy - (cell_size / 2.0 + wave)) < line_width && cy < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case FLORAL_LATTICE_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (cx < line_width || cx > cell_size - line_width ||
-              cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (fabs(cx - cell_size / 2.0) < line_width && fabs(cy - cell_size / 2.0) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CHEVRON_STRIPES_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cy = fmod(ty, cell_size);
-          gdouble chevron = fabs(fmod(tx, cell_size) - cell_size / 2.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(cy - chevron) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CHERRY_BLOSSOMS_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble petal_angle = fmod(angle * 180.0 / G_PI, 72.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (petal_angle < line_width && dist < cell_size / 4.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case SUNBURST_MOTIF_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble angle = atan2(dy, dx);
-          gdouble angle_mod = fmod(angle * 180.0 / G_PI, 30.0);
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (angle_mod < line_width && dist < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case MEANDER_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (cx < cell_size / 2.0 && cy > cell_size / 2.0 - line_width && cy < cell_size / 2.0 + line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (cx > cell_size / 2.0 - line_width && cx < cell_size / 2.0 + line_width && cy < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case DOUBLE_CHEVRON_BANDS:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cy = fmod(ty, cell_size);
-          gdouble chevron1 = fabs(fmod(tx, cell_size) - cell_size / 2.0);
-          gdouble chevron2 = fabs(fmod(tx + cell_size / 4.0, cell_size) - cell_size / 2.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(cy - chevron1) < line_width || fabs(cy - chevron2) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case OVERLAPPING_CIRCLE_WAVES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble wave = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
-          gdouble dx = cx - center_x + wave;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (dist > cell_size / 4.0 - line_width && dist < cell_size / 4.0 + line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case HEXAGON_WAVE_TILES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble hex_x = cx / (cell_size * 0.866);
-          gdouble hex_y = cy / cell_size;
-          gdouble hex_center_x = floor(hex_x) + 0.5;
-          gdouble hex_center_y = floor(hex_y) + 0.5;
-          if ((gint)floor(hex_y) % 2 == 1) hex_center_x += 0.5;
-          gdouble dx = (hex_x - hex_center_x) * cell_size * 0.866;
-          gdouble dy = (hex_y - hex_center_y) * cell_size;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (dist > cell_size / 2.5 - line_width && dist < cell_size / 2.5 + line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (dist < cell_size / 2.5 && fabs(dy - wave) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case WAVE_FRIEZE_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(cy - (cell_size / 2.0 + wave)) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CHEVRON_GRID_OVERLAY:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble chevron = fabs(fmod(cx, cell_size / 2.0) - cell_size / 4.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(cy - chevron) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (cx < line_width || cx > cell_size - line_width ||
-                   cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case INTERLOCKED_SQUARES_2:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (cx < line_width || cx > cell_size - line_width ||
-              cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (cx > cell_size / 4.0 - line_width && cx < cell_size / 4.0 + line_width &&
-                   cy < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          else if (cy > cell_size / 4.0 - line_width && cy < cell_size / 4.0 + line_width &&
-                   cx > cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CHEVRON_RIPPLE_EFFECT:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble ripple = sin((tx / tile_size) * 2.0 * G_PI) * (cell_size / 8.0);
-          gdouble chevron = fabs(fmod(cx, cell_size / 2.0) - cell_size / 4.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fabs(cy - (chevron + ripple)) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CIRCLE_LATTICE_FLOW:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble flow = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y + flow;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (dist > cell_size / 4.0 - line_width && dist < cell_size / 4.0 + line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case PALMETTE_WAVES_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble angle = atan2(dy, dx);
-          gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
-          gdouble palmette_angle = fmod(angle * 180.0 / G_PI, 90.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (palmette_angle < line_width && dy + wave < cell_size / 4.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case SPIRAL_MAZE_2:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble spiral = dist - (angle * cell_size / (3.0 * G_PI));
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (fmod(spiral, cell_size / 3.0) < line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case KEY_WAVE_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 6.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (cx > cell_size / 2.0 - line_width && cx < cell_size / 2.0 + line_width && cy + wave < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case ANTHEMION_MOTIF_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble anthemion_angle = fmod(angle * 180.0 / G_PI, 45.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (anthemion_angle < line_width && dist < cell_size / 3.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CHEVRON_MAZE_1:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble chevron = fabs(fmod(cx, cell_size / 2.0) - cell_size / 4.0);
-          gdouble base_line_width = cell_size * 0.1;
-          gdouble line_width = base_line_width * o->line_width;
-          if (cy < line_width || cy > cell_size - line_width)
-          {
-            in_shape = TRUE;
-          }
-          else if (fabs(cx - chevron) < line_width && cy < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case STAR_FRIEZE_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble star_angle = fmod(angle * 180.0 / G_PI, 45.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (star_angle < line_width && dist > cell_size / 4.0 && dist < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case LOTUS_WAVE_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble wave = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 8.0);
-          gdouble lotus_angle = fmod(angle * 180.0 / G_PI, 60.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (lotus_angle < line_width && dist + wave < cell_size / 3.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case STAR_LATTICE_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble star_angle = fmod(angle * 180.0 / G_PI, 45.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (star_angle < line_width && dist > cell_size / 3.0 && dist < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case ROSETTE_PATTERN_1:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble rosette_angle = fmod(angle * 180.0 / G_PI, 36.0);
-          gdouble base_line_width = cell_size * 0.05;
-          gdouble line_width = base_line_width * o->line_width;
-          if (rosette_angle < line_width && dist > cell_size / 4.0 && dist < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CONCENTRIC_RINGS:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble ring_spacing = cell_size / 8.0;
-          gdouble ring_mod = fmod(dist, ring_spacing);
-          gdouble base_line_width = cell_size * 0.1 * o->line_width;
-          if (ring_mod < base_line_width && dist < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case WAVY_STRIPES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble wave = sin((tx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble stripe = fmod(ty + wave, cell_size / 2.0);
-          gdouble base_line_width = cell_size * 0.2 * o->line_width;
-          if (stripe < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case ZIGZAG_STRIPES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble diag_x = (tx + ty) / sqrt(2.0);
-          gdouble diag_y = (ty - tx) / sqrt(2.0);
-          gdouble cd = fmod(diag_x, cell_size);
-          gdouble zigzag = fabs(fmod(cd, cell_size / 2.0) - cell_size / 4.0) * 2.0 - cell_size / 4.0;
-          gdouble stripe = fmod(diag_y + zigzag, cell_size / 2.0);
-          gdouble base_line_width = cell_size * 0.2 * o->line_width;
-          if (stripe < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case TWISTED_RIBBONS:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble amplitude = (cell_size / 4.0) * sin(ty * G_PI / cell_size);
-          gdouble wave = sin((ty / cell_size) * 2.0 * G_PI) * amplitude;
-          gdouble stripe = fmod(tx + wave, cell_size / 2.0);
-          gdouble base_line_width = cell_size * 0.2 * o->line_width;
-          if (stripe < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case INTERFERING_WAVES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble wave_h = sin((tx / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble stripe_h = fmod(ty + wave_h, cell_size / 2.0);
-          gdouble wave_v = sin((ty / cell_size) * 2.0 * G_PI) * (cell_size / 4.0);
-          gdouble stripe_v = fmod(tx + wave_v, cell_size / 2.0);
-          gdouble base_line_width = cell_size * 0.2 * o->line_width;
-          if (stripe_h < base_line_width || stripe_v < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CURVED_BANDS:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cy = fmod(ty, cell_size);
-          gdouble curve = sin((tx / cell_size) * 1.5 * G_PI) * (cell_size / 3.0);
-          gdouble band = fmod(cy + curve, cell_size / 2.0);
-          gdouble base_line_width = cell_size * 0.15 * o->line_width;
-          if (band < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case WAVE_CROSS:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble wave_x = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 5.0);
-          gdouble wave_y = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 5.0);
-          gdouble base_line_width = cell_size * 0.1 * o->line_width;
-          if (fabs(cx - (cell_size / 2.0 + wave_x)) < base_line_width ||
-              fabs(cy - (cell_size / 2.0 + wave_y)) < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case RIPPLE_GRID:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble ripple = sin(dist * 0.2) * (cell_size / 10.0);
-          gdouble base_line_width = cell_size * 0.1 * o->line_width;
-          if (fmod(cx + ripple, cell_size / 4.0) < base_line_width ||
-              fmod(cy + ripple, cell_size / 4.0) < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case PETAL_GRID:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble petal_angle = fmod(angle * 180.0 / G_PI, 40.0);
-          gdouble base_line_width = cell_size * 0.06 * o->line_width;
-          if (petal_angle < base_line_width && dist < cell_size / 3.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case WAVE_SPIKES:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble spike_angle = fmod(angle * 180.0 / G_PI, 30.0);
-          gdouble wave = sin(dist * 0.3) * (cell_size / 10.0);
-          gdouble base_line_width = cell_size * 0.06 * o->line_width;
-          if (spike_angle < base_line_width && dist + wave < cell_size / 2.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CIRCLE_WEAVE:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble wave_x = sin((cy / cell_size) * 2.0 * G_PI) * (cell_size / 6.0);
-          gdouble wave_y = sin((cx / cell_size) * 2.0 * G_PI) * (cell_size / 6.0);
-          gdouble base_line_width = cell_size * 0.08 * o->line_width;
-          if (dist > cell_size / 3.0 - base_line_width && dist < cell_size / 3.0 + base_line_width &&
-              (fabs(dx - wave_x) < base_line_width || fabs(dy - wave_y) < base_line_width))
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case GRID_SWIRLS:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble swirl = dist + angle * cell_size / (4.0 * G_PI);
-          gdouble grid_mod = fmod(cx, cell_size / 3.0) + fmod(cy, cell_size / 3.0);
-          gdouble base_line_width = cell_size * 0.1 * o->line_width;
-          if (fmod(swirl, cell_size / 4.0) < base_line_width && grid_mod < cell_size / 3.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case BRAIDED_STRIPS:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble wave1 = sin((cx / cell_size) * 1.5 * G_PI) * (cell_size / 4.0);
-          gdouble wave2 = sin((cx / cell_size) * 1.5 * G_PI + G_PI / 2.0) * (cell_size / 4.0);
-          gdouble base_line_width = cell_size * 0.1 * o->line_width;
-          if (fabs(cy - (cell_size / 2.0 + wave1)) < base_line_width ||
-              fabs(cy - (cell_size / 2.0 + wave2)) < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case WAVE_LATTICE:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble wave = sin((cx + cy) / cell_size * 2.0 * G_PI) * (cell_size / 5.0);
-          gdouble base_line_width = cell_size * 0.1 * o->line_width;
-          if (fmod(cx + wave, cell_size / 4.0) < base_line_width ||
-              fmod(cy + wave, cell_size / 4.0) < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case LOOP_MOTIF:
-        {
-          gdouble cell_size = tile_size / 5.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble center_x = cell_size / 2.0;
-          gdouble center_y = cell_size / 2.0;
-          gdouble dx = cx - center_x;
-          gdouble dy = cy - center_y;
-          gdouble dist = sqrt(dx * dx + dy * dy);
-          gdouble angle = atan2(dy, dx);
-          gdouble loop_angle = fmod(angle * 180.0 / G_PI, 90.0);
-          gdouble loop_dist = dist + sin(angle * 4.0) * (cell_size / 10.0);
-          gdouble base_line_width = cell_size * 0.06 * o->line_width;
-          if (loop_angle < base_line_width && loop_dist < cell_size / 3.0)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case CURVE_MAZE:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble curve = sin((cx / cell_size) * 1.5 * G_PI) * (cell_size / 3.0);
-          gdouble maze = fmod(cy + curve, cell_size / 3.0);
-          gdouble base_line_width = cell_size * 0.1 * o->line_width;
-          if (maze < base_line_width || fmod(cx, cell_size / 3.0) < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-        case PULSE_GRID:
-        {
-          gdouble cell_size = tile_size / 4.0;
-          gdouble cx = fmod(tx, cell_size);
-          gdouble cy = fmod(ty, cell_size);
-          gdouble pulse = sin((cx + cy) / cell_size * 2.0 * G_PI) * (cell_size / 6.0);
-          gdouble base_line_width = cell_size * 0.1 * o->line_width;
-          if (fmod(cx + pulse, cell_size / 4.0) < base_line_width &&
-              fmod(cy + pulse, cell_size / 4.0) < base_line_width)
-          {
-            in_shape = TRUE;
-          }
-          break;
-        }
-      }
+  // Sample at full resolution coordinates so previews at a lower mipmap
+  // level show the same pattern, antialiased for their own pixel size
+  coverage = g_new (gfloat, roi->width);
+  grok_trace_scratch (&span, roi->width * sizeof (gfloat));
+
+  coverage_rows_init (&rows, pattern_spans[o->pattern], &pp, o->antialias,
+                      (gdouble) roi->x * factor, (gdouble) roi->y * factor,
+                      factor, roi->width);
+
+  for (y = roi->y; y < roi->y + roi->height; y++)
+  {
+    coverage_rows_next (&rows, coverage);
+
+    for (x = 0; x < roi->width; x++)
+    {
+      gfloat *out = out_pixel;
+      gfloat  c = coverage[x];
 
-      if (in_shape)
+      if (c >= 1.0f)
       {
         out[0] = fg_color[0];
         out[1] = fg_color[1];
         out[2] = fg_color[2];
         out[3] = 1.0;
       }
-      else
+      else if (c <= 0.0f)
       {
         out[0] = bg_color[0];
         out[1] = bg_color[1];
         out[2] = bg_color[2];
         out[3] = 1.0;
       }
+      else
+      {
+        out[0] = bg_color[0] + (fg_color[0] - bg_color[0]) * c;
+        out[1] = bg_color[1] + (fg_color[1] - bg_color[1]) * c;
+        out[2] = bg_color[2] + (fg_color[2] - bg_color[2]) * c;
+        out[3] = 1.0;
+      }
 
-      gegl_buffer_set (output, GEGL_RECTANGLE (x, y, 1, 1), 0, babl_format ("RGBA float"), out, GEGL_AUTO_ROWSTRIDE);
+      out_pixel += 4;
     }
   }
 
+  coverage_rows_free (&rows);
+  g_free (coverage);
+  grok_trace_end (&span, n_pixels);
+
   return TRUE;
 }
 
 static void
 gegl_op_class_init (GeglOpClass *klass)
 {
-  GeglOperationClass *operation_class = GEGL_OPERATION_CLASS (klass);
+  GObjectClass                  *object_class = G_OBJECT_CLASS (klass);
+  GeglOperationClass            *operation_class = GEGL_OPERATION_CLASS (klass);
+  GeglOperationPointRenderClass *point_render_class = GEGL_OPERATION_POINT_RENDER_CLASS (klass);
+
+  object_class->finalize = finalize;
   operation_class->prepare = prepare;
   operation_class->get_bounding_box = get_bounding_box;
-  operation_class->process = process;
+  point_render_class->process = process;
 
   gegl_operation_class_set_keys (operation_class,
     "name",        "ai/lb:sine-waves",
     "title",       _("Sine Waves"),
     "reference-hash", "grok2sinewaves",
+    "position-dependent", "true",
     "description", _("Renders a variety of sinewave patterns with adjustable line width, rotation, and colors"),
     "gimp:menu-path", "<Image>/Filters/AI GEGL/",
     "gimp:menu-label", _("Sine Waves..."),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
@@ -0,0 +1,214 @@
+/* smooth-gradient.c
+ *
+ * Copyright (C) 2025 LinuxBeaver and contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* gegl:smooth followed by ai/lb:gradient in one pass.
+ *
+ * As two nodes the smoothed image is written to a buffer of its own and
+ * read back by the gradient, 16 bytes per pixel each way, and for a whole
+ * image render that buffer is as large as the image.  Here every row of a
+ * diffused band is mapped through the gradient as soon as it leaves the
+ * solver and the output is written once.  The result is the same as the
+ * two op chain with the same properties.
+ */
+
+#include "config.h"
+#include <glib/gi18n-lib.h>
+#include <math.h>
+#include <string.h>
+#include "grok-properties.h"
+
+#ifdef GEGL_PROPERTIES
+
+GROK_DIFFUSE_PROPERTIES (SmoothGradientSolver, smooth_gradient_solver)
+
+GROK_GRADIENT_PROPERTIES (SmoothGradientType, smooth_gradient_type,
+                          SmoothGradientShape, smooth_gradient_shape)
+
+#else
+
+#define GEGL_OP_FILTER
+#define GEGL_OP_NAME     smooth_gradient
+#define GEGL_OP_C_SOURCE smooth-gradient.c
+
+#include "gegl-op.h"
+#include "grok-trace.h"
+#include "grok-diffuse.h"
+#include "grok-gradient.h"
+
+typedef struct
+{
+  GeglProperties      *o;
+  GradientCache       *cache;
+  const GeglRectangle *canvas;
+  GradientGeometry     geometry;
+  gboolean             cached;
+  guint16             *scratch;
+} GradientRows;
+
+static void
+finalize (GObject *object)
+{
+  GeglOp         *self = GEGL_OP (object);
+  GeglProperties *o = GEGL_PROPERTIES (self);
+
+  g_clear_pointer (&o->user_data, gradient_cache_free);
+  G_OBJECT_CLASS (gegl_op_parent_class)->finalize (object);
+}
+
+static void
+prepare (GeglOperation *operation)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  const Babl     *format = babl_format ("RGBA float");
+
+  gegl_operation_set_format (operation, "input", format);
+  gegl_operation_set_format (operation, "output", format);
+
+  o->user_data = gradient_cache_update (o->user_data, o,
+                                        gegl_operation_source_get_bounding_box (operation, "input"));
+}
+
+static GeglRectangle
+get_bounding_box (GeglOperation *operation)
+{
+  GeglRectangle *in_rect = gegl_operation_source_get_bounding_box (operation, "input");
+  return in_rect ? *in_rect : (GeglRectangle){0, 0, 0, 0};
+}
+
+static GeglRectangle
+get_required_for_output (GeglOperation       *operation,
+                         const gchar         *input_pad,
+                         const GeglRectangle *roi)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  GeglRectangle   rect = *roi;
+  gint            halo;
+
+  if (o->full_frame)
+    return get_bounding_box (operation);
+
+  halo = get_halo (o, 0);
+  rect.x -= halo;
+  rect.y -= halo;
+  rect.width += 2 * halo;
+  rect.height += 2 * halo;
+  return rect;
+}
+
+static GeglRectangle
+get_invalidated_by_change (GeglOperation       *operation,
+                           const gchar         *input_pad,
+                           const GeglRectangle *input_region)
+{
+  return get_required_for_output (operation, input_pad, input_region);
+}
+
+static GeglRectangle
+get_cached_region (GeglOperation       *operation,
+                   const GeglRectangle *roi)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+
+  if (o->full_frame)
+    return get_bounding_box (operation);
+  return *roi;
+}
+
+/* The gradient half of the chain, on one smoothed row */
+static void
+map_row (const GeglRectangle *out_rect,
+         gint                 y,
+         gfloat              *pixels,
+         gpointer             data)
+{
+  GradientRows  *rows = data;
+  const guint16 *row_index;
+
+  if (y == out_rect->y)
+    rows->cached = gradient_field_covers (&rows->cache->field, &rows->geometry,
+                                          rows->o, rows->canvas, out_rect);
+
+  row_index = gradient_row_index (&rows->cache->field, &rows->geometry, rows->cached,
+                                  out_rect->x, y, out_rect->width, &rows->scratch);
+  gradient_map_row (&rows->cache->lut, row_index, pixels, pixels, out_rect->width,
+                    rows->o->blend, rows->o->alpha_lock);
+}
+
+static GrokTraceOp *trace_op;
+
+static gboolean
+process (GeglOperation       *operation,
+         GeglBuffer          *input,
+         GeglBuffer          *output,
+         const GeglRectangle *result,
+         gint                 level)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  const Babl     *format = babl_format ("RGBA float");
+  GeglRectangle  *in_rect = gegl_operation_source_get_bounding_box (operation, "input");
+  GradientRows    rows = { o, o->user_data, in_rect, };
+  GeglRectangle   out_rect;
+  GrokTraceSpan   span;
+
+  grok_trace_begin (&span, trace_op, result, level);
+
+  if (!diffuse_region (o, input, output, in_rect, result, level, format,
+                       map_row, &rows, &out_rect, &span))
+    {
+      grok_trace_end (&span, 0);
+      return TRUE;
+    }
+
+  if (rows.scratch)
+    grok_trace_scratch (&span, out_rect.width * sizeof (guint16));
+  g_free (rows.scratch);
+
+  grok_trace_end (&span, (guint64) out_rect.width * out_rect.height);
+  return TRUE;
+}
+
+static void
+gegl_op_class_init (GeglOpClass *klass)
+{
+  GObjectClass             *object_class = G_OBJECT_CLASS (klass);
+  GeglOperationClass       *operation_class = GEGL_OPERATION_CLASS (klass);
+  GeglOperationFilterClass *filter_class = GEGL_OPERATION_FILTER_CLASS (klass);
+
+  diffuse_init ();
+
+  object_class->finalize                     = finalize;
+  operation_class->prepare                   = prepare;
+  operation_class->get_bounding_box          = get_bounding_box;
+  operation_class->get_required_for_output   = get_required_for_output;
+  operation_class->get_invalidated_by_change = get_invalidated_by_change;
+  operation_class->get_cached_region         = get_cached_region;
+  filter_class->process                      = process;
+
+  gegl_operation_class_set_keys (operation_class,
+    "name",        "ai/lb:smooth-gradient",
+    "title",       _("Smoothed Gradient Map"),
+    "reference-hash", "smoothgradient2025",
+    "description", _("Intense anisotropic smoothing followed by a seamless gradient map, in one pass without an intermediate buffer; the same result as gegl:smooth feeding ai/lb:gradient"),
+    "gimp:menu-path", "<Image>/Filters/AI GEGL",
+    "gimp:menu-label", _("Smoothed Gradient Map..."),
+    NULL);
+
+  trace_op = grok_trace_register (operation_class);
+}
+
+#endif
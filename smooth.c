@@ -21,33 +21,12 @@
 #include "config.h"
 #include <glib/gi18n-lib.h>
 #include <math.h>
+#include <string.h>
+#include "grok-properties.h"
 
 #ifdef GEGL_PROPERTIES
 
-property_int (iterations, _("Iterations"), 10)
-  description (_("Number of iterations; more iterations cause stronger smoothing"))
-  value_range (1, 20)
-  ui_range (1, 15)
-
-property_double (alpha, _("Alpha"), 0.6)
-  description (_("Diffusion strength in homogeneous regions"))
-  value_range (0.1, 1.0)
-  ui_range (0.1, 0.8)
-
-property_double (kappa, _("Kappa"), 4.0)
-  description (_("Edge sensitivity parameter; lower values preserve sharper edges"))
-  value_range (1.0, 15.0)
-  ui_range (1.0, 10.0)
-
-property_double (strength, _("Strength"), 2.5)
-  description (_("Overall intensity of the smoothing effect"))
-  value_range (0.5, 5.0)
-  ui_range (0.5, 4.0)
-
-property_double (delta_t, _("Delta T"), 0.3)
-  description (_("Time step for numerical stability"))
-  value_range (0.05, 0.5)
-  ui_range (0.05, 0.4)
+GROK_DIFFUSE_PROPERTIES (SmoothSolver, smooth_solver)
 
 #else
 
@@ -56,6 +35,8 @@ property_double (delta_t, _("Delta T"), 0.3)
 #define GEGL_OP_C_SOURCE smooth.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
+#include "grok-diffuse.h"
 
 static void
 prepare (GeglOperation *operation)
@@ -77,157 +58,221 @@ get_required_for_output (GeglOperation       *operation,
                         const gchar         *input_pad,
                         const GeglRectangle *roi)
 {
-  return get_bounding_box (operation);
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  GeglRectangle   rect = *roi;
+  gint            halo;
+
+  if (o->full_frame)
+    return get_bounding_box (operation);
+
+  halo = get_halo (o, 0);
+  rect.x -= halo;
+  rect.y -= halo;
+  rect.width += 2 * halo;
+  rect.height += 2 * halo;
+  return rect;
 }
 
-static inline gfloat
-conductance (gfloat gradient, gfloat kappa)
+static GeglRectangle
+get_invalidated_by_change (GeglOperation       *operation,
+                           const gchar         *input_pad,
+                           const GeglRectangle *input_region)
 {
-  gfloat g = gradient / kappa;
-  return expf (-g * g); /* Gaussian conductance for edge-preserving smoothing */
+  return get_required_for_output (operation, input_pad, input_region);
 }
 
-static gboolean
-process (GeglOperation       *operation,
-         GeglBuffer          *input,
-         GeglBuffer          *output,
-         const GeglRectangle *result,
-         gint                 level)
+static GeglRectangle
+get_cached_region (GeglOperation       *operation,
+                   const GeglRectangle *roi)
 {
   GeglProperties *o = GEGL_PROPERTIES (operation);
-  const Babl *format = babl_format ("RGBA float");
-  GeglBufferIterator *iter;
-  GeglBuffer *temp;
-  gint i;
 
-  if (result->width < 2 || result->height < 2)
+  if (o->full_frame)
+    return get_bounding_box (operation);
+  return *roi;
+}
+
+#ifdef HAVE_OPENCL
+#include "opencl/gegl-cl.h"
+#include "gegl-buffer-cl-iterator.h"
+
+#include "opencl/smooth.cl.h"
+
+static GeglClRunData *cl_data = NULL;
+
+/* All iterations stay on the device, ping-ponging between in_tex and
+ * aux_tex; both carry a halo wide margin around roi and every iteration
+ * shrinks the computed area by one pixel, so the last one covers exactly
+ * roi.  Returns TRUE on error.
+ */
+static gboolean
+cl_smooth (cl_mem               in_tex,
+           cl_mem               aux_tex,
+           cl_mem               out_tex,
+           const GeglRectangle *roi,
+           const GeglRectangle *in_rect,
+           gint                 halo,
+           GeglProperties      *o)
+{
+  cl_int   cl_err = 0;
+  cl_int   stride = roi->width + 2 * halo;
+  cl_int   in_offset = halo * stride + halo;
+  cl_int4  valid = {{0, 0, stride, roi->height + 2 * halo}};
+  cl_float kappa = o->kappa;
+  cl_float alpha_strength = o->alpha * o->strength;
+  cl_float delta_t = o->delta_t;
+  size_t   gbl_size[2] = {roi->width, roi->height};
+  gint     i;
+
+  if (!cl_data)
     {
-      if (input != output)
-        gegl_buffer_copy (input, result, GEGL_ABYSS_CLAMP, output, result);
-      return TRUE;
+      const char *kernel_name[] = {"smooth_cl", "transfer", NULL};
+      cl_data = gegl_cl_compile_and_build (smooth_cl_source, kernel_name);
     }
+  if (!cl_data)
+    return TRUE;
 
-  /* Create a temporary buffer for intermediate results */
-  temp = gegl_buffer_new (result, format);
-  gegl_buffer_copy (input, result, GEGL_ABYSS_CLAMP, temp, result);
+  /* The image bounds in texture coordinates */
+  if (in_rect)
+    {
+      valid.s[0] = MAX (in_rect->x - (roi->x - halo), 0);
+      valid.s[1] = MAX (in_rect->y - (roi->y - halo), 0);
+      valid.s[2] = MIN (in_rect->x + in_rect->width - (roi->x - halo), valid.s[2]);
+      valid.s[3] = MIN (in_rect->y + in_rect->height - (roi->y - halo), valid.s[3]);
+    }
 
-  /* Perform diffusion iterations */
   for (i = 0; i < o->iterations; i++)
     {
-      iter = gegl_buffer_iterator_new (temp, result, 0, format,
-                                      GEGL_ACCESS_READ, GEGL_ABYSS_LOOP, 2);
-      gegl_buffer_iterator_add (iter, output, result, 0, format,
-                               GEGL_ACCESS_WRITE, GEGL_ABYSS_CLAMP);
+      cl_int  margin = halo - o->iterations + i + 1;
+      size_t  gbl_size_tmp[2];
+      cl_mem  temp_tex;
+
+      gbl_size_tmp[0] = stride - 2 * margin;
+      gbl_size_tmp[1] = roi->height + 2 * halo - 2 * margin;
+
+      cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                        sizeof (cl_mem),   &in_tex,
+                                        sizeof (cl_mem),   &aux_tex,
+                                        sizeof (cl_int),   &stride,
+                                        sizeof (cl_int),   &margin,
+                                        sizeof (cl_int4),  &valid,
+                                        sizeof (cl_float), &kappa,
+                                        sizeof (cl_float), &alpha_strength,
+                                        sizeof (cl_float), &delta_t,
+                                        NULL);
+      CL_CHECK;
+
+      cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                            cl_data->kernel[0], 2,
+                                            NULL, gbl_size_tmp, NULL,
+                                            0, NULL, NULL);
+      CL_CHECK;
+
+      temp_tex = aux_tex;
+      aux_tex  = in_tex;
+      in_tex   = temp_tex;
+    }
+
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[1],
+                                    sizeof (cl_mem), &in_tex,
+                                    sizeof (cl_int), &stride,
+                                    sizeof (cl_int), &in_offset,
+                                    sizeof (cl_mem), &out_tex,
+                                    NULL);
+  CL_CHECK;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        cl_data->kernel[1], 2,
+                                        NULL, gbl_size, NULL,
+                                        0, NULL, NULL);
+  CL_CHECK;
+
+  return FALSE;
 
-      while (gegl_buffer_iterator_next (iter))
+error:
+  return TRUE;
+}
+
+static gboolean
+cl_process (GeglOperation       *operation,
+            GeglBuffer          *input,
+            GeglBuffer          *output,
+            const GeglRectangle *result)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  const Babl *format = babl_format ("RGBA float");
+  GeglRectangle *in_rect = gegl_operation_source_get_bounding_box (operation, "input");
+  GeglBufferClIterator *i;
+  gint halo = get_halo (o, 0);
+  gint read;
+  gint aux;
+  gint err = 0;
+
+  i = gegl_buffer_cl_iterator_new (output, result, format,
+                                   GEGL_CL_BUFFER_WRITE);
+  read = gegl_buffer_cl_iterator_add_2 (i, input, result, format,
+                                        GEGL_CL_BUFFER_READ,
+                                        halo, halo, halo, halo,
+                                        GEGL_ABYSS_CLAMP);
+  aux = gegl_buffer_cl_iterator_add_aux (i, result, format,
+                                         halo, halo, halo, halo);
+
+  while (gegl_buffer_cl_iterator_next (i, &err) && !err)
+    {
+      err = cl_smooth (i->tex[read], i->tex[aux], i->tex[0],
+                       &i->roi[0], in_rect, halo, o);
+      if (err)
         {
-          gfloat *in_data = iter->items[0].data;
-          gfloat *out_data = iter->items[1].data;
-          GeglRectangle roi = iter->items[0].roi;
-          GeglRectangle in_roi = roi;
-          /* Expand ROI by 2 pixels for gradient calculations */
-          in_roi.x -= 2;
-          in_roi.y -= 2;
-          in_roi.width += 4;
-          in_roi.height += 4;
-          gegl_rectangle_intersect (&in_roi, &in_roi, result);
-
-          /* Create a temporary buffer for the expanded ROI */
-          gfloat *in_expanded = g_new0 (gfloat, in_roi.width * in_roi.height * 4);
-          GeglBufferIterator *in_iter = gegl_buffer_iterator_new (temp, &in_roi, 0, format,
-                                                                 GEGL_ACCESS_READ, GEGL_ABYSS_LOOP, 1);
-          while (gegl_buffer_iterator_next (in_iter))
-            {
-              gfloat *data = in_iter->items[0].data;
-              GeglRectangle r = in_iter->items[0].roi;
-              gint x, y;
-              for (y = 0; y < r.height; y++)
-                for (x = 0; x < r.width; x++)
-                  {
-                    gint src_idx = (y * r.width + x) * 4;
-                    gint dst_idx = ((y + r.y - in_roi.y) * in_roi.width + (x + r.x - in_roi.x)) * 4;
-                    memcpy (in_expanded + dst_idx, data + src_idx, 4 * sizeof (gfloat));
-                  }
-            }
-
-          for (gint y = 0; y < roi.height; y++)
-            {
-              for (gint x = 0; x < roi.width; x++)
-                {
-                  gint offset = (y * roi.width + x) * 4;
-                  gint in_x = x + roi.x - in_roi.x;
-                  gint in_y = y + roi.y - in_roi.y;
-                  gint in_offset = (in_y * in_roi.width + in_x) * 4;
-                  gfloat sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-                  gfloat weights[4] = {0.0f};
-                  gfloat gradients[4][4] = {{0.0f}};
-                  gint j;
-
-                  /* Compute gradients in four directions (N, S, E, W) */
-                  if (in_x > 0) /* West */
-                    {
-                      gint idx = (in_y * in_roi.width + (in_x - 1)) * 4;
-                      for (j = 0; j < 4; j++)
-                        gradients[0][j] = in_expanded[idx + j] - in_expanded[in_offset + j];
-                      weights[0] = conductance (fabsf (gradients[0][0]), o->kappa);
-                    }
-
-                  if (in_x < in_roi.width - 1) /* East */
-                    {
-                      gint idx = (in_y * in_roi.width + (in_x + 1)) * 4;
-                      for (j = 0; j < 4; j++)
-                        gradients[1][j] = in_expanded[idx + j] - in_expanded[in_offset + j];
-                      weights[1] = conductance (fabsf (gradients[1][0]), o->kappa);
-                    }
-
-                  if (in_y > 0) /* North */
-                    {
-                      gint idx = ((in_y - 1) * in_roi.width + in_x) * 4;
-                      for (j = 0; j < 4; j++)
-                        gradients[2][j] = in_expanded[idx + j] - in_expanded[in_offset + j];
-                      weights[2] = conductance (fabsf (gradients[2][0]), o->kappa);
-                    }
-
-                  if (in_y < in_roi.height - 1) /* South */
-                    {
-                      gint idx = ((in_y + 1) * in_roi.width + in_x) * 4;
-                      for (j = 0; j < 4; j++)
-                        gradients[3][j] = in_expanded[idx + j] - in_expanded[in_offset + j];
-                      weights[3] = conductance (fabsf (gradients[3][0]), o->kappa);
-                    }
-
-                  /* Update pixel values */
-                  gfloat weight_sum = weights[0] + weights[1] + weights[2] + weights[3];
-                  if (weight_sum > 1e-6f)
-                    {
-                      gfloat w = o->alpha * o->strength / weight_sum;
-                      for (j = 0; j < 4; j++)
-                        {
-                          sum[j] = w * (weights[0] * gradients[0][j] +
-                                        weights[1] * gradients[1][j] +
-                                        weights[2] * gradients[2][j] +
-                                        weights[3] * gradients[3][j]);
-                          sum[j] = CLAMP (sum[j], -2.0f, 2.0f); /* Wider clamp for stronger effect */
-                        }
-                    }
-
-                  for (j = 0; j < 4; j++)
-                    {
-                      gfloat value = in_data[offset + j] + o->delta_t * sum[j];
-                      out_data[offset + j] = CLAMP (value, 0.0f, 1.0f);
-                    }
-                }
-            }
-
-          g_free (in_expanded);
+          gegl_buffer_cl_iterator_stop (i);
+          break;
         }
+    }
+
+  return !err;
+}
+#endif /* HAVE_OPENCL */
 
-      /* Copy output to temp for next iteration */
-      gegl_buffer_copy (output, result, GEGL_ABYSS_CLAMP, temp, result);
+static GrokTraceOp *trace_op;
+
+static gboolean
+process (GeglOperation       *operation,
+         GeglBuffer          *input,
+         GeglBuffer          *output,
+         const GeglRectangle *result,
+         gint                 level)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  const Babl *format = babl_format ("RGBA float");
+  GeglRectangle out_rect;
+  GrokTraceSpan span;
+
+  grok_trace_begin (&span, trace_op, result, level);
+
+#ifdef HAVE_OPENCL
+  /* The device path only does the plain explicit mode; on failure the
+   * CPU path below takes over.
+   */
+  if (!o->full_frame && o->solver == SMOOTH_SOLVER_EXPLICIT &&
+      o->pyramid_levels == 0 && level == 0 &&
+      result->width >= 2 && result->height >= 2 &&
+      gegl_operation_use_opencl (operation))
+    if (cl_process (operation, input, output, result))
+      {
+        grok_trace_iterations (&span, o->iterations);
+        grok_trace_end (&span, (guint64) result->width * result->height);
+        return TRUE;
+      }
+#endif
+
+  if (!diffuse_region (o, input, output,
+                       gegl_operation_source_get_bounding_box (operation, "input"),
+                       result, level, format, NULL, NULL, &out_rect, &span))
+    {
+      grok_trace_end (&span, 0);
+      return TRUE;
     }
 
-  /* Clean up */
-  g_object_unref (temp);
+  grok_trace_end (&span, (guint64) out_rect.width * out_rect.height);
   return TRUE;
 }
 
@@ -237,10 +282,17 @@ gegl_op_class_init (GeglOpClass *klass)
   GeglOperationClass     *operation_class = GEGL_OPERATION_CLASS (klass);
   GeglOperationFilterClass *filter_class  = GEGL_OPERATION_FILTER_CLASS (klass);
 
+  diffuse_init ();
+
   operation_class->prepare         = prepare;
   operation_class->get_bounding_box = get_bounding_box;
   operation_class->get_required_for_output = get_required_for_output;
+  operation_class->get_invalidated_by_change = get_invalidated_by_change;
+  operation_class->get_cached_region = get_cached_region;
   filter_class->process            = process;
+#ifdef HAVE_OPENCL
+  operation_class->opencl_support = TRUE;
+#endif
 
   gegl_operation_class_set_keys (operation_class,
     "name",        "gegl:smooth",
@@ -250,6 +302,8 @@ gegl_op_class_init (GeglOpClass *klass)
     "gimp:menu-path", "<Image>/Filters/Blur",
     "gimp:menu-label", _("Intense Anisotropic Smooth"),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
@@ -3,6 +3,7 @@
 #include <math.h>
 #include <gegl.h>
 #include <gegl-plugin.h>
+#include "grok-polar.h"
 
 #ifdef GEGL_PROPERTIES
 
@@ -53,21 +54,80 @@ property_boolean (ccw, _("Counter-Clockwise"), FALSE)
 property_boolean (shade_edge, _("Shade Edge"), FALSE)
     description (_("Enable smooth shading for spiral edges"))
 
+property_double (phase, _("Phase"), 0.0)
+    description (_("Rotation of the spiral arms in degrees, for animating a spinning spiral"))
+    value_range (-360.0, 360.0)
+
 #else
 
 #define GEGL_OP_POINT_FILTER
-#define GEGL_OP_NAME     grok2
-#define GEGL_OP_C_SOURCE grok2.c
+#define GEGL_OP_NAME     candy_spiral
+#define GEGL_OP_C_SOURCE spiralworking/grok2.c
 
 #include "gegl-op.h"
+#include "grok-trace.h"
+
+static void
+spiral_geometry (GeglOperation       *operation,
+                 const GeglRectangle *roi,
+                 gfloat              *cx,
+                 gfloat              *cy,
+                 gfloat              *max_radius)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+
+  // Get full canvas dimensions
+  GeglRectangle *canvas = gegl_operation_source_get_bounding_box (operation, "input");
+  gfloat canvas_width = canvas ? canvas->width : roi->width;
+  gfloat canvas_height = canvas ? canvas->height : roi->height;
+
+  // Center relative to full canvas
+  *cx = o->x * canvas_width;
+  *cy = o->y * canvas_height;
+  *max_radius = sqrt (canvas_width * canvas_width + canvas_height * canvas_height) / 2.0;
+}
+
+static void
+finalize (GObject *object)
+{
+  GeglOp *self = GEGL_OP (object);
+  GeglProperties *o = GEGL_PROPERTIES (self);
+
+  if (o->user_data)
+    {
+      grok_polar_field_clear (o->user_data);
+      g_clear_pointer (&o->user_data, g_free);
+    }
+  G_OBJECT_CLASS (gegl_op_parent_class)->finalize (object);
+}
 
 static void
 prepare (GeglOperation *operation)
 {
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  GeglRectangle *canvas = gegl_operation_source_get_bounding_box (operation, "input");
+  gfloat cx, cy, max_radius;
+
   gegl_operation_set_format (operation, "input", babl_format ("RGBA float"));
   gegl_operation_set_format (operation, "output", babl_format ("RGBA float"));
+
+  if (!o->user_data)
+    o->user_data = g_new0 (GrokPolarField, 1);
+
+  // The polar field only depends on the canvas and the centre
+  if (canvas)
+    {
+      spiral_geometry (operation, canvas, &cx, &cy, &max_radius);
+      grok_polar_field_update (o->user_data, canvas, cx, cy, max_radius);
+    }
+  else
+    {
+      grok_polar_field_update (o->user_data, NULL, 0.0, 0.0, 0.0);
+    }
 }
 
+static GrokTraceOp *trace_op;
+
 static gboolean
 process (GeglOperation       *operation,
          void               *in_buf,
@@ -77,7 +137,12 @@ process (GeglOperation       *operation,
          gint                level)
 {
   GeglProperties *o = GEGL_PROPERTIES (operation);
+  GrokPolarField *field = o->user_data;
   gfloat *out_pixel = (gfloat *) out_buf;
+  gfloat *scratch = NULL;
+  GrokTraceSpan span;
+
+  grok_trace_begin (&span, trace_op, roi, level);
 
   gfloat c1[4], c2[4], c3[4], c4[4], c5[4], bg[4];
   gegl_color_get_pixel (o->color1, babl_format ("RGBA float"), c1);
@@ -86,125 +151,129 @@ process (GeglOperation       *operation,
   gegl_color_get_pixel (o->color4, babl_format ("RGBA float"), c4);
   gegl_color_get_pixel (o->color5, babl_format ("RGBA float"), c5);
   gegl_color_get_pixel (o->bg_color, babl_format ("RGBA float"), bg);
+  gfloat *colors[5] = { c1, c2, c3, c4, c5 };
 
-  // Get full canvas dimensions
-  GeglRectangle *canvas = gegl_operation_source_get_bounding_box (operation, "input");
-  gfloat canvas_width = canvas ? canvas->width : roi->width;
-  gfloat canvas_height = canvas ? canvas->height : roi->height;
+  gfloat cx, cy, max_radius;
+  spiral_geometry (operation, roi, &cx, &cy, &max_radius);
 
-  // Center relative to full canvas
-  gfloat cx = o->x * canvas_width;
-  gfloat cy = o->y * canvas_height;
-  gfloat max_radius = sqrt (canvas_width * canvas_width + canvas_height * canvas_height) / 2.0;
   gfloat base_arm_width = G_PI / o->arms; // Base width per arm
   gfloat arm_width = base_arm_width * o->thickness; // Scale with thickness
   gfloat color_segment_width = base_arm_width / 5.0; // Width per color segment
+  gfloat arm_period = 2.0 * G_PI / o->arms;
+  gfloat inv_arm_period = 1.0 / arm_period;
+  gfloat phase = o->phase * G_PI / 180.0;
 
-  for (glong i = 0; i < n_pixels; i++)
+  // Archimedean spiral: theta = k * r
+  gfloat twist = o->twist * 2.0 * G_PI;
+  if (o->ccw)
+    twist = -twist;
+
+  gboolean cached = field && grok_polar_field_covers (field, roi, cx, cy, max_radius);
+
+  for (gint row = 0; row < roi->height; row++)
   {
-    // Compute global coordinates
-    gint x = (i % roi->width) + roi->x;
-    gint y = (i / roi->width) + roi->y;
-
-    gfloat dx = x - cx;
-    gfloat dy = y - cy;
-    gfloat dist = sqrt (dx * dx + dy * dy);
-    gfloat norm_dist = dist / max_radius;
-    gfloat angle = atan2 (dy, dx);
-    if (angle < 0)
-      angle += 2.0 * G_PI;
-
-    // Archimedean spiral: theta = k * r
-    gfloat spiral_angle = norm_dist * o->twist * 2.0 * G_PI;
-    if (o->ccw)
-      spiral_angle = -spiral_angle;
-
-    gfloat total_angle = angle + spiral_angle;
-    if (total_angle < 0)
-      total_angle += 2.0 * G_PI;
-
-    // Normalize angle to current arm
-    gfloat arm_angle = fmod (total_angle, 2.0 * G_PI / o->arms);
-    if (arm_angle < 0)
-      arm_angle += 2.0 * G_PI / o->arms;
-
-    // Calculate color segment within arm
-    gfloat color_angle = fmod (total_angle, 2.0 * G_PI / o->arms);
-    if (color_angle < 0)
-      color_angle += 2.0 * G_PI / o->arms;
-    gint color_index = (gint) (color_angle / color_segment_width) % 5;
-    gfloat *color;
-    switch (color_index)
+    const gfloat *polar = NULL;
+
+    if (cached)
     {
-      case 0: color = c1; break;
-      case 1: color = c2; break;
-      case 2: color = c3; break;
-      case 3: color = c4; break;
-      case 4: color = c5; break;
-      default: color = bg; // Fallback
+      polar = grok_polar_field_fetch_row (field, roi->x, roi->y + row);
     }
-
-    // Shading for smooth edges
-    if (o->shade_edge)
+    if (!polar)
     {
-      gfloat t = arm_angle / (arm_width * 1.5); // Wider blending zone
-      if (t <= 1.0)
-      {
-        // Cosine-based blending for smoother transition
-        gfloat alpha = 0.5 * (1.0 - cos(t * G_PI));
-        out_pixel[0] = color[0] * alpha + bg[0] * (1.0 - alpha);
-        out_pixel[1] = color[1] * alpha + bg[1] * (1.0 - alpha);
-        out_pixel[2] = color[2] * alpha + bg[2] * (1.0 - alpha);
-        out_pixel[3] = 1.0;
-      }
-      else
+      if (!scratch)
       {
-        out_pixel[0] = bg[0];
-        out_pixel[1] = bg[1];
-        out_pixel[2] = bg[2];
-        out_pixel[3] = bg[3];
+        scratch = g_new (gfloat, roi->width * 2);
+        grok_trace_scratch (&span, roi->width * 2 * sizeof (gfloat));
       }
+      grok_polar_row (cx, cy, max_radius, roi->x, roi->y + row, roi->width, scratch);
+      polar = scratch;
     }
-    else
+
+    for (gint col = 0; col < roi->width; col++)
     {
-      // Hard-edged rendering
-      if (arm_angle <= arm_width)
+      gfloat angle = polar[col * 2 + 0];
+      gfloat norm_dist = polar[col * 2 + 1];
+      gfloat total_angle = angle + norm_dist * twist + phase;
+
+      // Normalize angle to current arm
+      gfloat arm_angle = total_angle - floorf (total_angle * inv_arm_period) * arm_period;
+      if (arm_angle >= arm_period)
+        arm_angle -= arm_period;
+      if (arm_angle < 0)
+        arm_angle = 0;
+
+      // Calculate color segment within arm
+      gfloat *color = colors[(gint) (arm_angle / color_segment_width) % 5];
+
+      // Shading for smooth edges
+      if (o->shade_edge)
       {
-        out_pixel[0] = color[0];
-        out_pixel[1] = color[1];
-        out_pixel[2] = color[2];
-        out_pixel[3] = 1.0;
+        gfloat t = arm_angle / (arm_width * 1.5); // Wider blending zone
+        if (t <= 1.0)
+        {
+          // Cosine-based blending for smoother transition
+          gfloat alpha = 0.5 * (1.0 - cosf (t * G_PI));
+          out_pixel[0] = color[0] * alpha + bg[0] * (1.0 - alpha);
+          out_pixel[1] = color[1] * alpha + bg[1] * (1.0 - alpha);
+          out_pixel[2] = color[2] * alpha + bg[2] * (1.0 - alpha);
+          out_pixel[3] = 1.0;
+        }
+        else
+        {
+          out_pixel[0] = bg[0];
+          out_pixel[1] = bg[1];
+          out_pixel[2] = bg[2];
+          out_pixel[3] = bg[3];
+        }
       }
       else
       {
-        out_pixel[0] = bg[0];
-        out_pixel[1] = bg[1];
-        out_pixel[2] = bg[2];
-        out_pixel[3] = bg[3];
+        // Hard-edged rendering
+        if (arm_angle <= arm_width)
+        {
+          out_pixel[0] = color[0];
+          out_pixel[1] = color[1];
+          out_pixel[2] = color[2];
+          out_pixel[3] = 1.0;
+        }
+        else
+        {
+          out_pixel[0] = bg[0];
+          out_pixel[1] = bg[1];
+          out_pixel[2] = bg[2];
+          out_pixel[3] = bg[3];
+        }
       }
-    }
 
-    out_pixel += 4;
+      out_pixel += 4;
+    }
   }
 
+  g_free (scratch);
+  grok_trace_end (&span, n_pixels);
+
   return TRUE;
 }
 
 static void
 gegl_op_class_init (GeglOpClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GeglOperationClass *operation_class = GEGL_OPERATION_CLASS (klass);
   GeglOperationPointFilterClass *point_filter_class = GEGL_OPERATION_POINT_FILTER_CLASS (klass);
 
+  object_class->finalize = finalize;
   operation_class->prepare = prepare;
   point_filter_class->process = process;
 
   gegl_operation_class_set_keys (operation_class,
-    "name", "gegl:grok2",
+    "name", "grok:candy-spiral",
     "title", _("Candy Spiral Starburst"),
     "reference-hash", "candy_spiral",
     "description", _("Generates a multicolor Archimedean spiral with five customizable colors, creating a vibrant starburst effect"),
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif
@@ -16,11 +16,13 @@
  * Copyright 2025 Beaver, Grok Tentacles
  */
 
+#include "config.h"
 #include <gegl.h>
 #include <gegl-plugin.h>
 #include <glib-object.h>
 #include <math.h>
-#include <stdlib.h>
+#include <string.h>
+#include "grok-trace.h"
 
 G_BEGIN_DECLS
 
@@ -50,21 +52,23 @@ typedef struct _GeglOpGrokClass
   GeglOperationPointComposerClass parent_class;
 } GeglOpGrokClass;
 
-GType gegl_op_grok_get_type (void) G_GNUC_CONST;
-
 static void get_property (GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
 static void set_property (GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec);
 static gboolean process (GeglOperation *operation,
                         void *input,
                         void *aux,
                         void *output,
+                        glong n_pixels,
                         const GeglRectangle *result,
                         gint level);
 static void gegl_op_grok_class_init (GeglOpGrokClass *klass);
+static void gegl_op_grok_class_finalize (GeglOpGrokClass *klass);
 static void gegl_op_grok_init (GeglOpGrok *self);
 
 G_END_DECLS
 
+G_DEFINE_DYNAMIC_TYPE (GeglOpGrok, gegl_op_grok, GEGL_TYPE_OPERATION_POINT_COMPOSER)
+
 static void
 hsl_to_rgb (gdouble h, gdouble s, gdouble l, gdouble *r, gdouble *g, gdouble *b)
 {
@@ -129,113 +133,247 @@ set_property (GObject *object, guint prop_id, const GValue *value, GParamSpec *p
   }
 }
 
+/* Every tentacle draws its parameters from a counter-based hash of the
+ * seed, its index and a parameter slot, so any chunk can regenerate the
+ * same strokes without shared generator state.
+ */
+static gdouble
+tentacle_random (guint32 seed, gint tentacle, gint slot)
+{
+  guint32 h = seed * 0x9e3779b9u ^ (guint32) tentacle * 0x85ebca6bu ^ (guint32) slot * 0xc2b2ae35u;
+
+  h ^= h >> 16;
+  h *= 0x7feb352du;
+  h ^= h >> 15;
+  h *= 0x846ca68bu;
+  h ^= h >> 16;
+
+  return h / 4294967296.0;
+}
+
+typedef struct
+{
+  gdouble base_x, base_y;
+  gdouble amp, freq, phase;
+  gdouble max_len, base_thickness;
+  gdouble r, g, b;
+  GeglRectangle shadow_bounds;
+  GeglRectangle body_bounds;
+} Tentacle;
+
+#define SHADOW_OFFSET 5.0
+
+/* Pixels a stroke can touch: the wave stays within amp of its base line
+ * and the stamp is widest at the root.
+ */
+static void
+stroke_bounds (const Tentacle *tentacle, gdouble offset, gdouble width, GeglRectangle *bounds)
+{
+  gdouble reach = tentacle->amp + ceil (width) + 1.0;
+  gdouble x0 = tentacle->base_x + offset - reach;
+  gdouble y0 = tentacle->base_y + offset - reach;
+
+  bounds->x = (gint) floor (x0);
+  bounds->y = (gint) floor (y0);
+  bounds->width = (gint) ceil (tentacle->base_x + offset + tentacle->max_len + reach) - bounds->x + 1;
+  bounds->height = (gint) ceil (tentacle->base_y + offset + reach) - bounds->y + 1;
+}
+
+static void
+init_tentacle (GeglOpGrok *self, const GeglRectangle *canvas, gint t, Tentacle *tentacle)
+{
+  tentacle->base_x = (gint) (tentacle_random (self->seed, t, 0) * canvas->width) + canvas->x;
+  tentacle->base_y = (gint) (tentacle_random (self->seed, t, 1) * canvas->height) + canvas->y;
+  tentacle->amp = self->curvature * (0.5 + (gint) (tentacle_random (self->seed, t, 2) * 100) / 200.0);
+  tentacle->freq = 0.05 + (gint) (tentacle_random (self->seed, t, 3) * 50) / 1000.0;
+  tentacle->phase = (gint) (tentacle_random (self->seed, t, 4) * 360) * G_PI / 180.0;
+  tentacle->max_len = self->length * (0.5 + (gint) (tentacle_random (self->seed, t, 5) * 100) / 200.0);
+  tentacle->base_thickness = self->thickness * (0.5 + (gint) (tentacle_random (self->seed, t, 6) * 100) / 200.0);
+
+  hsl_to_rgb (self->hue + ((gint) (tentacle_random (self->seed, t, 7) * 60) - 30), 0.7, self->lightness / 30.0 + 0.5,
+              &tentacle->r, &tentacle->g, &tentacle->b);
+
+  /* Shadow: offset and slightly wider for blur effect */
+  stroke_bounds (tentacle, SHADOW_OFFSET, tentacle->base_thickness * 1.2, &tentacle->shadow_bounds);
+  stroke_bounds (tentacle, 0.0, tentacle->base_thickness, &tentacle->body_bounds);
+}
+
+/* A stroke is generated once as a list of stamps shared by its shadow and
+ * its body.  Samples are spaced so that consecutive stamps are a fraction
+ * of the local width apart on screen, but never closer along the stroke
+ * than the original half step, so the wide root is not restamped with
+ * heavy overdraw.
+ */
+#define STAMP_SPACING    0.05
+#define STAMP_MAX_RADIUS 64
+
+typedef struct
+{
+  gint   x, y;   /* stamp centre, floored */
+  gfloat width;
+  gfloat fade;   /* 1 - t along the stroke */
+} Stamp;
+
+/* Distance of every integer offset from a stamp centre, shared by all
+ * stamps up to STAMP_MAX_RADIUS */
+static gfloat stamp_distance[(STAMP_MAX_RADIUS + 1) * (STAMP_MAX_RADIUS + 1)];
+
+static void
+init_stamp_distance (void)
+{
+  for (gint dy = 0; dy <= STAMP_MAX_RADIUS; dy++)
+    for (gint dx = 0; dx <= STAMP_MAX_RADIUS; dx++)
+      stamp_distance[dy * (STAMP_MAX_RADIUS + 1) + dx] = sqrtf (dx * dx + dy * dy);
+}
+
+static gint
+generate_stamps (const Tentacle *tentacle, Stamp *stamps)
+{
+  gint n = 0;
+
+  for (gdouble s = 0; s < tentacle->max_len; ) {
+    gdouble t = s / tentacle->max_len;
+    gdouble x = tentacle->base_x + s + tentacle->amp * sin (tentacle->freq * s + tentacle->phase);
+    gdouble y = tentacle->base_y + tentacle->amp * cos (tentacle->freq * s + tentacle->phase);
+    gdouble width = tentacle->base_thickness * exp (-2.0 * t);
+
+    stamps[n].x = (gint) floor (x);
+    stamps[n].y = (gint) floor (y);
+    stamps[n].width = width;
+    stamps[n].fade = 1.0 - t;
+    n++;
+
+    /* Screen-space speed along the wave */
+    gdouble vx = 1.0 + tentacle->amp * tentacle->freq * cos (tentacle->freq * s + tentacle->phase);
+    gdouble vy = tentacle->amp * tentacle->freq * sin (tentacle->freq * s + tentacle->phase);
+    gdouble speed = sqrt (vx * vx + vy * vy);
+
+    s += MAX (0.5, width * STAMP_SPACING / MAX (speed, 1e-3));
+  }
+
+  return n;
+}
+
+static gint
+max_stamps (const Tentacle *tentacle)
+{
+  return (gint) ceil (tentacle->max_len / 0.5) + 1;
+}
+
+/* Composite a stroke's stamps into the chunk, touching only the pixels of
+ * each stamp that fall inside it.  The shadow is offset and slightly wider
+ * for blur effect.
+ */
+static void
+render_stamps (GeglOpGrok          *self,
+               const Tentacle      *tentacle,
+               const Stamp         *stamps,
+               gint                 n_stamps,
+               gboolean             shadow,
+               gfloat              *out_buf,
+               const GeglRectangle *result)
+{
+  gint   offset = shadow ? (gint) SHADOW_OFFSET : 0;
+  gfloat scale = shadow ? 1.2f : 1.0f;
+  gfloat opacity = shadow ? self->shadow_opacity * 0.5 : self->opacity;
+  gfloat color[3] = { 0.0f, 0.0f, 0.0f }; /* Dark shadow */
+
+  if (!shadow) {
+    color[0] = tentacle->r;
+    color[1] = tentacle->g;
+    color[2] = tentacle->b;
+  }
+
+  for (gint i = 0; i < n_stamps; i++) {
+    const Stamp *stamp = &stamps[i];
+    gfloat width = stamp->width * scale;
+    gfloat inv_width = 1.0f / width;
+    gint   radius = MIN ((gint) ceilf (width), STAMP_MAX_RADIUS);
+    gint   fx = stamp->x + offset;
+    gint   fy = stamp->y + offset;
+    gint   dx0 = MAX (-radius, result->x - fx);
+    gint   dx1 = MIN (radius, result->x + result->width - 1 - fx);
+    gint   dy0 = MAX (-radius, result->y - fy);
+    gint   dy1 = MIN (radius, result->y + result->height - 1 - fy);
+
+    for (gint dy = dy0; dy <= dy1; dy++) {
+      const gfloat *distance = stamp_distance + ABS (dy) * (STAMP_MAX_RADIUS + 1);
+      gfloat       *row = out_buf + ((fy + dy - result->y) * result->width + (fx - result->x)) * 4;
+
+      for (gint dx = dx0; dx <= dx1; dx++) {
+        gfloat dist = distance[ABS (dx)];
+        if (dist <= width) {
+          gfloat *pixel = row + dx * 4;
+          gfloat  shade = 1.0f - dist * inv_width;
+          gfloat  alpha = opacity * shade * stamp->fade;
+
+          pixel[0] = color[0] * shade;
+          pixel[1] = color[1] * shade;
+          pixel[2] = color[2] * shade;
+          pixel[3] = MAX (pixel[3], alpha);
+        }
+      }
+    }
+  }
+}
+
+static GrokTraceOp *trace_op;
+
 static gboolean
 process (GeglOperation *operation,
          void *input,
          void *aux,
          void *output,
+         glong n_pixels,
          const GeglRectangle *result,
          gint level)
 {
   GeglOpGrok *self = GEGL_OP_GROK (operation);
-  GeglBuffer *output_buf = (GeglBuffer *) output;
-  gfloat *out_buf = g_new (gfloat, result->width * result->height * 4);
-  gint i;
-
-  /* Initialize output buffer (transparent) */
-  for (i = 0; i < result->width * result->height * 4; i += 4) {
-    out_buf[i] = 0.0f;   /* R */
-    out_buf[i+1] = 0.0f; /* G */
-    out_buf[i+2] = 0.0f; /* B */
-    out_buf[i+3] = 0.0f; /* A */
-  }
+  gfloat *out_buf = output;
+  Tentacle tentacles[50];
+  Stamp *stamps[50] = { NULL, };
+  gint n_stamps[50] = { 0, };
+  GrokTraceSpan span;
 
-  /* Initialize random seed */
-  srand (self->seed);
+  grok_trace_begin (&span, trace_op, result, level);
 
-  /* Render shadows first */
+  /* Initialize output chunk (transparent) */
+  memset (out_buf, 0, sizeof (gfloat) * 4 * n_pixels);
+
+  /* Tentacles are placed on the input canvas, not on the chunk being
+   * rendered, so every chunk sees the same strokes */
+  const GeglRectangle *canvas = gegl_operation_source_get_bounding_box (operation, "input");
+  if (!canvas || gegl_rectangle_is_empty (canvas))
+    canvas = result;
+
+  /* Generate each stroke that reaches this chunk once */
   gint count = (gint) CLAMP (self->tentacle_count, 1.0, 50.0);
   for (int t = 0; t < count; t++) {
-    gdouble base_x = (rand () % result->width) + result->x;
-    gdouble base_y = (rand () % result->height) + result->y;
-    gdouble amp = self->curvature * (0.5 + (rand () % 100) / 200.0);
-    gdouble freq = 0.05 + (rand () % 50) / 1000.0;
-    gdouble phase = (rand () % 360) * G_PI / 180.0;
-    gdouble max_len = self->length * (0.5 + (rand () % 100) / 200.0);
-    gdouble base_thickness = self->thickness * (0.5 + (rand () % 100) / 200.0);
-
-    /* Shadow: darker, offset, slightly blurred */
-    for (gdouble s = 0; s < max_len; s += 0.5) {
-      gdouble t = s / max_len;
-      gdouble x = base_x + s + amp * sin (freq * s + phase) + 5.0; /* Offset for shadow */
-      gdouble y = base_y + amp * cos (freq * s + phase) + 5.0;
-      gdouble width = base_thickness * exp (-2.0 * t) * 1.2; /* Slightly wider for blur effect */
-
-      for (int dy = -ceil(width); dy <= ceil(width); dy++) {
-        for (int dx = -ceil(width); dx <= ceil(width); dx++) {
-          gdouble dist = sqrt (dx * dx + dy * dy);
-          if (dist <= width) {
-            gint px = (gint) (x + dx - result->x);
-            gint py = (gint) (y + dy - result->y);
-            if (px >= 0 && px < result->width && py >= 0 && py < result->height) {
-              gint idx = (py * result->width + px) * 4;
-              gdouble shade = 1.0 - dist / width;
-              gfloat alpha = self->shadow_opacity * shade * (1.0 - t) * 0.5;
-              out_buf[idx] = 0.0f; /* Dark shadow */
-              out_buf[idx+1] = 0.0f;
-              out_buf[idx+2] = 0.0f;
-              out_buf[idx+3] = MAX (out_buf[idx+3], alpha);
-            }
-          }
-        }
-      }
+    init_tentacle (self, canvas, t, &tentacles[t]);
+
+    if (gegl_rectangle_intersect (NULL, &tentacles[t].shadow_bounds, result) ||
+        gegl_rectangle_intersect (NULL, &tentacles[t].body_bounds, result)) {
+      stamps[t] = g_new (Stamp, max_stamps (&tentacles[t]));
+      grok_trace_scratch (&span, max_stamps (&tentacles[t]) * sizeof (Stamp));
+      n_stamps[t] = generate_stamps (&tentacles[t], stamps[t]);
     }
   }
 
+  /* Render shadows first */
+  for (int t = 0; t < count; t++)
+    if (gegl_rectangle_intersect (NULL, &tentacles[t].shadow_bounds, result))
+      render_stamps (self, &tentacles[t], stamps[t], n_stamps[t], TRUE, out_buf, result);
+
   /* Render tentacles */
-  srand (self->seed); /* Reset seed for consistent placement */
-  for (int t = 0; t < count; t++) {
-    gdouble base_x = (rand () % result->width) + result->x;
-    gdouble base_y = (rand () % result->height) + result->y;
-    gdouble amp = self->curvature * (0.5 + (rand () % 100) / 200.0);
-    gdouble freq = 0.05 + (rand () % 50) / 1000.0;
-    gdouble phase = (rand () % 360) * G_PI / 180.0;
-    gdouble max_len = self->length * (0.5 + (rand () % 100) / 200.0);
-    gdouble base_thickness = self->thickness * (0.5 + (rand () % 100) / 200.0);
-
-    gdouble r, g, b;
-    hsl_to_rgb (self->hue + (rand () % 60 - 30), 0.7, self->lightness / 30.0 + 0.5, &r, &g, &b);
-
-    for (gdouble s = 0; s < max_len; s += 0.5) {
-      gdouble t = s / max_len;
-      gdouble x = base_x + s + amp * sin (freq * s + phase);
-      gdouble y = base_y + amp * cos (freq * s + phase);
-      gdouble width = base_thickness * exp (-2.0 * t);
-
-      for (int dy = -ceil(width); dy <= ceil(width); dy++) {
-        for (int dx = -ceil(width); dx <= ceil(width); dx++) {
-          gdouble dist = sqrt (dx * dx + dy * dy);
-          if (dist <= width) {
-            gint px = (gint) (x + dx - result->x);
-            gint py = (gint) (y + dy - result->y);
-            if (px >= 0 && px < result->width && py >= 0 && py < result->height) {
-              gint idx = (py * result->width + px) * 4;
-              gdouble shade = 1.0 - dist / width;
-              gfloat alpha = self->opacity * shade * (1.0 - t);
-              out_buf[idx] = r * shade;
-              out_buf[idx+1] = g * shade;
-              out_buf[idx+2] = b * shade;
-              out_buf[idx+3] = MAX (out_buf[idx+3], alpha);
-            }
-          }
-        }
-      }
-    }
-  }
+  for (int t = 0; t < count; t++)
+    if (gegl_rectangle_intersect (NULL, &tentacles[t].body_bounds, result))
+      render_stamps (self, &tentacles[t], stamps[t], n_stamps[t], FALSE, out_buf, result);
+
+  for (int t = 0; t < count; t++)
+    g_free (stamps[t]);
+
+  grok_trace_end (&span, n_pixels);
 
-  /* Write to output buffer */
-  gegl_buffer_set (output_buf, result, 0, babl_format ("RGBA float"), out_buf, GEGL_AUTO_ROWSTRIDE);
-  g_free (out_buf);
   return TRUE;
 }
 
@@ -256,6 +394,8 @@ gegl_op_grok_class_init (GeglOpGrokClass *klass)
   object_class->get_property = get_property;
   point_class->process = process;
 
+  init_stamp_distance ();
+
   g_object_class_install_property (object_class, 1,
     g_param_spec_double ("tentacle-count", "Tentacle Count", "Number of tentacles",
                          1.0, 50.0, 10.0, G_PARAM_READWRITE));
@@ -285,13 +425,36 @@ gegl_op_grok_class_init (GeglOpGrokClass *klass)
                        0, G_MAXUINT, 0, G_PARAM_READWRITE));
 
   gegl_operation_class_set_keys (operation_class,
-    "name", "gegl:grok",
+    "name", "grok:tentacles",
     "title", "Grok Tentacles",
     "categories", "render",
     "description", "Renders 2D octopus-like tentacles inspired by Xscreensaver Sky Tentacles",
     "gimp:menu-path", "<Image>/Filters/Grok/",
     "gimp:menu-label", "Grok Tentacles...",
     NULL);
+
+  trace_op = grok_trace_register (operation_class);
+}
+
+static void
+gegl_op_grok_class_finalize (GeglOpGrokClass *klass)
+{
 }
 
-#endif
+static const GeglModuleInfo modinfo =
+{
+  GEGL_MODULE_ABI_VERSION
+};
+
+G_MODULE_EXPORT const GeglModuleInfo *
+gegl_module_query (GTypeModule *module)
+{
+  return &modinfo;
+}
+
+G_MODULE_EXPORT gboolean
+gegl_module_register (GTypeModule *module)
+{
+  gegl_op_grok_register_type (module);
+  return TRUE;
+}
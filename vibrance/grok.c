@@ -1,20 +1,8 @@
 #include "config.h"
-#include <gegl.h>
-#include <gegl-plugin.h>
+#include <glib/gi18n-lib.h>
 #include <math.h>
 
-#define GEGL_OP_FILTER
-#define GEGL_OP_NAME     grok
-#define GEGL_OP_C_SOURCE grok.c
-
-#define RGB_LUMINANCE(r,g,b) (0.2126 * (r) + 0.7152 * (g) + 0.0722 * (b))
-
-GEGL_DEFINE_DYNAMIC_OPERATION(GEGL_TYPE_OPERATION_FILTER)
-
-/* Operation properties */
-enum_start (gegl_grok_vibrance)
-  enum_value (GEGL_GROK_VIBRANCE, "vibrance", N_("Vibrance effect like G'MIC"))
-enum_end (GeglGrokVibrance)
+#ifdef GEGL_PROPERTIES
 
 property_double (strength, _("Strength"), 1.0)
     description (_("Vibrance adjustment strength"))
@@ -22,115 +10,123 @@ property_double (strength, _("Strength"), 1.0)
     ui_range    (-2.0, 2.0)
     ui_meta     ("unit", "relative")
 
-/* RGB to HSL conversion */
-static void
-rgb_to_hsl (gfloat r, gfloat g, gfloat b, gfloat *h, gfloat *s, gfloat *l)
-{
-  gfloat max = fmaxf (fmaxf (r, g), b);
-  gfloat min = fminf (fminf (r, g), b);
-  gfloat delta = max - min;
+#else
+
+#define GEGL_OP_POINT_FILTER
+#define GEGL_OP_NAME     vibrance
+#define GEGL_OP_C_SOURCE vibrance/grok.c
+
+#include "gegl-op.h"
+#include "grok-trace.h"
+#include "grok-kernel.h"
+
+/* Vibrance only rescales HSL saturation while hue and lightness stay put.
+ * With H and L fixed every channel sits at l + (c - l), where c - l is
+ * proportional to S, so the HSL round trip collapses to scaling each
+ * channel's distance from l by s' / s.  That leaves no per-pixel trig or
+ * branches, and 8 pixels are processed at a time with GCC vector
+ * extensions, cloned per ISA on x86-64 through GROK_KERNEL.
+ */
+#if defined (__GNUC__) && (__GNUC__ >= 9 || defined (__clang__))
+typedef gfloat VibranceVec  __attribute__ ((vector_size (32)));
+typedef gint32 VibranceMask __attribute__ ((vector_size (32)));
+#define HAVE_VIBRANCE_VECTOR 1
+
+/* Per-lane mask ? a : b */
+#define vibrance_select(mask, a, b) \
+  ((VibranceVec) (((VibranceMask) (a) & (mask)) | ((VibranceMask) (b) & ~(mask))))
+#endif
 
-  *l = (max + min) / 2.0;
+/* Gain s' / s applied to a pixel of HSL saturation s */
+static inline gfloat
+vibrance_gain (gfloat s, gfloat strength)
+{
+  gfloat boosted = CLAMP (s + strength * (1.0f - s) * s, 0.0f, 1.0f);
 
-  if (delta == 0.0)
-    {
-      *s = 0.0;
-      *h = 0.0; /* Undefined, but set to 0 */
-    }
-  else
-    {
-      *s = (*l > 0.5) ? delta / (2.0 - max - min) : delta / (max + min);
-      if (max == r)
-        *h = (g - b) / delta + (g < b ? 6.0 : 0.0);
-      else if (max == g)
-        *h = (b - r) / delta + 2.0;
-      else
-        *h = (r - g) / delta + 4.0;
-      *h /= 6.0;
-    }
+  return boosted / s;
 }
 
-/* HSL to RGB conversion */
-static gfloat
-hue_to_rgb (gfloat p, gfloat q, gfloat t)
+static inline void
+vibrance_pixel (const gfloat *in, gfloat *out, gfloat strength)
 {
-  if (t < 0.0) t += 1.0;
-  if (t > 1.0) t -= 1.0;
-  if (t < 1.0 / 6.0) return p + (q - p) * 6.0 * t;
-  if (t < 1.0 / 2.0) return q;
-  if (t < 2.0 / 3.0) return p + (q - p) * (2.0 / 3.0 - t) * 6.0;
-  return p;
-}
+  gfloat max = fmaxf (fmaxf (in[0], in[1]), in[2]);
+  gfloat min = fminf (fminf (in[0], in[1]), in[2]);
+  gfloat delta = max - min;
+  gfloat l = (max + min) * 0.5f;
+  gint   c;
 
-static void
-hsl_to_rgb (gfloat h, gfloat s, gfloat l, gfloat *r, gfloat *g, gfloat *b)
-{
-  if (s == 0.0)
+  if (delta != 0.0f)
     {
-      *r = *g = *b = l; /* Achromatic */
+      gfloat s = delta / (l > 0.5f ? 2.0f - max - min : max + min);
+      gfloat gain = vibrance_gain (s, strength);
+
+      for (c = 0; c < 3; c++)
+        out[c] = l + (in[c] - l) * gain;
     }
   else
     {
-      gfloat q = l < 0.5 ? l * (1.0 + s) : l + s - l * s;
-      gfloat p = 2.0 * l - q;
-      *r = hue_to_rgb (p, q, h + 1.0 / 3.0);
-      *g = hue_to_rgb (p, q, h);
-      *b = hue_to_rgb (p, q, h - 1.0 / 3.0);
+      for (c = 0; c < 3; c++)
+        out[c] = in[c];
     }
+  out[3] = in[3];
 }
 
-/* Process function: Apply vibrance effect */
-static gboolean
-process (GeglOperation       *operation,
-         GeglBuffer          *input,
-         GeglBuffer          *output,
-         const GeglRectangle *roi,
-         gint                 level)
+GROK_KERNEL
+static void
+vibrance_run (const gfloat *in, gfloat *out, gint n, gfloat strength)
 {
-  GeglProperties *o = GEGL_PROPERTIES (operation);
-  gfloat strength = o->strength;
-  GeglBufferIterator *it;
-
-  it = gegl_buffer_iterator_new (input, roi, level, babl_format ("R'G'B'A float"), GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  gegl_buffer_iterator_add (it, output, roi, level, babl_format ("R'G'B'A float"), GEGL_ACCESS_WRITE);
+  gint i = 0;
 
-  while (gegl_buffer_iterator_next (it))
+#ifdef HAVE_VIBRANCE_VECTOR
+  for (; i + 8 <= n; i += 8)
     {
-      gfloat *in_data = (gfloat *) it->data[0];
-      gfloat *out_data = (gfloat *) it->data[1];
-      gint pixels = it->length;
+      const gfloat *src = in + i * 4;
+      gfloat       *dst = out + i * 4;
+      const VibranceVec zero = { 0 };
+      VibranceVec   r, g, b, max, min, sum, l, s, boosted, gain;
+      VibranceMask  chroma;
+      gint          j;
+
+      for (j = 0; j < 8; j++)
+        {
+          r[j] = src[j * 4 + 0];
+          g[j] = src[j * 4 + 1];
+          b[j] = src[j * 4 + 2];
+        }
 
-      for (gint i = 0; i < pixels; i++)
+      max = vibrance_select (r > g, r, g);
+      max = vibrance_select (max > b, max, b);
+      min = vibrance_select (r < g, r, g);
+      min = vibrance_select (min < b, min, b);
+      sum = max + min;
+      l = sum * 0.5f;
+      chroma = max != min;
+
+      /* Grey lanes divide by zero here; they are restored below */
+      s = (max - min) / vibrance_select (l > 0.5f, 2.0f - sum, sum);
+      boosted = s + strength * (1.0f - s) * s;
+      boosted = vibrance_select (boosted < 0.0f, zero, boosted);
+      boosted = vibrance_select (boosted > 1.0f, zero + 1.0f, boosted);
+      gain = boosted / s;
+
+      r = vibrance_select (chroma, l + (r - l) * gain, r);
+      g = vibrance_select (chroma, l + (g - l) * gain, g);
+      b = vibrance_select (chroma, l + (b - l) * gain, b);
+
+      for (j = 0; j < 8; j++)
         {
-          gfloat r = in_data[i * 4 + 0];
-          gfloat g = in_data[i * 4 + 1];
-          gfloat b = in_data[i * 4 + 2];
-          gfloat a = in_data[i * 4 + 3];
-          gfloat h, s, l;
-
-          /* Convert RGB to HSL */
-          rgb_to_hsl (r, g, b, &h, &s, &l);
-
-          /* Adjust saturation: boost low-saturation colors more */
-          gfloat vibrance = strength * (1.0 - s); /* More boost for less saturated */
-          s = CLAMP (s + vibrance * s, 0.0, 1.0);
-
-          /* Convert back to RGB */
-          hsl_to_rgb (h, s, l, &r, &g, &b);
-
-          /* Write to output */
-          out_data[i * 4 + 0] = r;
-          out_data[i * 4 + 1] = g;
-          out_data[i * 4 + 2] = b;
-          out_data[i * 4 + 3] = a;
+          dst[j * 4 + 0] = r[j];
+          dst[j * 4 + 1] = g[j];
+          dst[j * 4 + 2] = b[j];
+          dst[j * 4 + 3] = src[j * 4 + 3];
         }
     }
+#endif
 
-  gegl_buffer_iterator_destroy (it);
-  return TRUE;
+  for (; i < n; i++)
+    vibrance_pixel (in + i * 4, out + i * 4, strength);
 }
 
-/* Specify input/output formats */
 static void
 prepare (GeglOperation *operation)
 {
@@ -138,29 +134,46 @@ prepare (GeglOperation *operation)
   gegl_operation_set_format (operation, "output", babl_format ("R'G'B'A float"));
 }
 
-/* GObject boilerplate */
+static GrokTraceOp *trace_op;
+
+static gboolean
+process (GeglOperation       *operation,
+         void                *in_buf,
+         void                *out_buf,
+         glong                n_pixels,
+         const GeglRectangle *roi,
+         gint                 level)
+{
+  GeglProperties *o = GEGL_PROPERTIES (operation);
+  GrokTraceSpan span;
+
+  grok_trace_begin (&span, trace_op, roi, level);
+  vibrance_run (in_buf, out_buf, n_pixels, o->strength);
+  grok_trace_end (&span, n_pixels);
+
+  return TRUE;
+}
+
 static void
-gegl_op_class_init (GeglOperationClass *klass)
+gegl_op_class_init (GeglOpClass *klass)
 {
-  GeglOperationFilterClass *filter_class = GEGL_OPERATION_FILTER_CLASS (klass);
+  GeglOperationClass            *operation_class;
+  GeglOperationPointFilterClass *point_filter_class;
 
-  filter_class->process = process;
-  klass->prepare = prepare;
+  operation_class    = GEGL_OPERATION_CLASS (klass);
+  point_filter_class = GEGL_OPERATION_POINT_FILTER_CLASS (klass);
 
-  gegl_operation_class_set_keys (klass,
-    "name",        "gegl:grok",
+  operation_class->prepare = prepare;
+  point_filter_class->process = process;
+
+  gegl_operation_class_set_keys (operation_class,
+    "name",        "grok:vibrance",
     "title",       _("Vibrance Effect"),
     "categories",  "color",
     "description", _("Adjusts vibrance by enhancing less saturated colors, similar to G'MIC's vibrance effect"),
     NULL);
-}
-
-G_DEFINE_DYNAMIC_TYPE (GeglOp, gegl_op, GEGL_TYPE_OPERATION_FILTER)
 
-static void
-gegl_module_register (GTypeModule *module)
-{
-  gegl_op_register_type (module);
+  trace_op = grok_trace_register (operation_class);
 }
 
 #endif